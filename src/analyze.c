@@ -29,7 +29,9 @@ static void analysis_start(GAME *game);
 
 void analyze_mode(GAME *game)
 {
-    memcpy(&analysis_game, game, sizeof(GAME));
+    //  Full board copy: moves can be undone during analysis.
+    memcpy(&analysis_game.board, &game->board, sizeof(BOARD));
+    game_share_caches(&analysis_game, game);
 
     THREAD_CREATE(analysis_thread, analysis_start, &analysis_game);
 
@@ -118,6 +120,10 @@ void analysis_start(GAME *game)
     settings.single_move_time = MAX_TIME;
     settings.total_move_time = MAX_TIME;
     settings.use_book = FALSE;
+    settings.increment = 0;
+    settings.max_nodes = 0;
+    settings.mate_in = 0;
+    settings.search_moves_count = 0;
 
     search_run(game, &settings);
 }
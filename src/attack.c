@@ -41,14 +41,7 @@
 #define BB_BQSK     ((U64)0x7C7C000000000000)
 #define BB_BQSP     ((U64)0x007C000000000000)
 
-//    Castle functions.
-int     is_white_kingside_attacked(BOARD *board);
-int     is_white_queenside_attacked(BOARD *board);
-int     is_black_kingside_attacked(BOARD *board);
-int     is_black_queenside_attacked(BOARD *board);
-
 //  Utility functions.
-int     is_square_attacked(BOARD *board, int square, int by_color, U64 occup);
 int     is_aligned(int s1, int s2, int s3);
 
 //-------------------------------------------------------------------------------------------------
@@ -82,14 +75,7 @@ int is_pseudo_legal(BOARD *board, U64 pins, MOVE move)
     case MT_CSBKS: return is_black_kingside_attacked(board) ? FALSE : TRUE;
     case MT_CSWQS: return is_white_queenside_attacked(board) ? FALSE : TRUE;
     case MT_CSWKS: return is_white_kingside_attacked(board) ? FALSE : TRUE;
-    case MT_EPCAP:
-        make_move(board, move);
-        if (is_illegal(board, move)) {
-            undo_move(board);
-            return FALSE;
-        }
-        undo_move(board);
-        return TRUE;
+    case MT_EPCAP: return is_en_passant_legal(board, move);
     }
 
     if (unpack_piece(move) == KING) {
@@ -105,7 +91,7 @@ int is_pseudo_legal(BOARD *board, U64 pins, MOVE move)
 }
 
 //-------------------------------------------------------------------------------------------------
-//    Locate pinned pieces to king. Used by is_pseudo_legal in order to avoid leaving king in check.
+//    Locate pinned pieces to king. Used by move generation in order to avoid leaving king in check.
 //-------------------------------------------------------------------------------------------------
 U64 find_pins(BOARD *board)
 {
@@ -128,6 +114,39 @@ U64 find_pins(BOARD *board)
     return pins;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Squares a pinned piece can move to: the line through its king, which contains the pinner.
+//-------------------------------------------------------------------------------------------------
+U64 pin_mask_bb(int king_square, int from_square)
+{
+    if (get_rank(king_square) == get_rank(from_square) || get_file(king_square) == get_file(from_square))
+        return rankfile_moves_bb(king_square) & rankfile_moves_bb(from_square);
+    return diagonal_moves_bb(king_square) & diagonal_moves_bb(from_square);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Verify if en passant capture leaves king in check without making the move. Both pawns leave
+//  their squares, so only sliding pieces can discover an attack.
+//-------------------------------------------------------------------------------------------------
+int is_en_passant_legal(BOARD *board, MOVE move)
+{
+    int     myc = side_on_move(board);
+    int     opp = flip_color(myc);
+    int     ksq = king_square(board, myc);
+    U64     occup = occupied_bb(board);
+
+    assert(unpack_type(move) == MT_EPCAP);
+
+    occup ^= square_bb(unpack_from(move)) | square_bb(unpack_ep_pawn_square(move));
+    occup |= square_bb(unpack_to(move));
+
+    if (bb_rook_attacks(ksq, occup) & queen_rook_bb(board, opp))
+        return FALSE;
+    if (bb_bishop_attacks(ksq, occup) & queen_bishop_bb(board, opp))
+        return FALSE;
+    return TRUE;
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Test if squares are aligned. (Copied from stockfish)
 //-------------------------------------------------------------------------------------------------
@@ -137,6 +156,39 @@ int is_aligned(int s1, int s2, int s3)
          & (square_bb(s1) | square_bb(s2) | square_bb(s3)) ? TRUE : FALSE;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Verify if a pseudo legal move (see is_valid) is legal, without making the move. Used for moves
+//  not coming from the move generators: when in check the move must capture the single checker
+//  or block it, or be a king move.
+//-------------------------------------------------------------------------------------------------
+int is_legal(BOARD *board, U64 pins, int incheck, MOVE move)
+{
+    if (incheck && unpack_piece(move) != KING) {
+        int     myc = side_on_move(board);
+        int     opp = flip_color(myc);
+        int     ksq = king_square(board, myc);
+        U64     occup = occupied_bb(board);
+        U64     target;
+        BBIX    checkers;
+
+        checkers.u64 = knight_moves_bb(ksq) & knight_bb(board, opp);
+        checkers.u64 |= bb_rook_attacks(ksq, occup) & queen_rook_bb(board, opp);
+        checkers.u64 |= bb_bishop_attacks(ksq, occup) & queen_bishop_bb(board, opp);
+        checkers.u64 |= pawn_attack_bb(opp, ksq) & pawn_bb(board, opp);
+
+        //  double check: only king moves
+        if (checkers.u64 & (checkers.u64 - 1)) return FALSE;
+
+        target = checkers.u64 | from_to_path_bb(ksq, bb_first(checkers));
+        if (!bb_is_one(target, unpack_to(move))) {
+            if (!move_is_en_passant(move) || !bb_is_one(checkers.u64, unpack_ep_pawn_square(move))) return FALSE;
+        }
+    }
+    if (incheck && move_is_castle(move)) return FALSE;
+
+    return is_pseudo_legal(board, pins, move);
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Verify if move made leaves king in check.
 //-------------------------------------------------------------------------------------------------
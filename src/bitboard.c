@@ -17,6 +17,10 @@ You can find the GNU General Public License at http://www.gnu.org/licenses/
 
 #include "globals.h"
 
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+#endif
+
 //-------------------------------------------------------------------------------------------------
 //  Bitboard functions.
 //
@@ -34,14 +38,36 @@ You can find the GNU General Public License at http://www.gnu.org/licenses/
 #undef USE_BBIX_STRUCT
 #endif
 
+//  Bit scan and count backend, selected at compile time. Compiler intrinsics use the
+//  LZCNT/TZCNT (BSR/BSF) and POPCNT instructions. The 16 bit lookup tables are kept as fallback
+//  and can be forced with -DUSE_BB_TABLES. Square A8 is the leftmost bit, so the first index
+//  is the count of leading zeros.
+#if !defined(USE_BB_TABLES)
+#if defined(__GNUC__) || defined(__clang__)
+#define USE_BB_BUILTIN
+#if defined(__POPCNT__)
+#define USE_BB_POPCNT
+#endif
+#elif defined(_MSC_VER) && defined(_WIN64)
+#define USE_BB_BUILTIN
+#if defined(__AVX__)
+#define USE_BB_POPCNT
+#endif
+#endif
+#endif
+
 // Bitboards
 U64     bb_square[64];           // bitboard for each board square
 U64     bb_clear[64];            // bitboard used to clear bits
 
 // Index tables for bit location and count within a bitboard.
+#if !defined(USE_BB_BUILTIN)
 S8      first_index_table[4][65536];
 S8      last_index_table[4][65536];
+#endif
+#if !defined(USE_BB_POPCNT)
 U8      bit_count_table[65536];
+#endif
 
 // Local functions
 void    init_square_bb(void);
@@ -59,9 +85,27 @@ S8      get_last_index(U16 value);
 void bb_init(void)
 {
     init_square_bb();
+#if !defined(USE_BB_BUILTIN)
     init_first_index_table();
     init_last_index_table();
+#endif
+#if !defined(USE_BB_POPCNT)
     init_count_table();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Description of bit scan and count implementation in use.
+//-------------------------------------------------------------------------------------------------
+char *bb_backend_name(void)
+{
+#if defined(USE_BB_BUILTIN) && defined(USE_BB_POPCNT)
+    return "bitscan intrinsics, popcnt";
+#elif defined(USE_BB_BUILTIN)
+    return "bitscan intrinsics, popcount tables";
+#else
+    return "bitscan and popcount tables";
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -78,6 +122,7 @@ void init_square_bb(void)
     }
 }
 
+#if !defined(USE_BB_BUILTIN)
 //-------------------------------------------------------------------------------------------------
 //  Table used to give first index on a bitboard
 //-------------------------------------------------------------------------------------------------
@@ -117,8 +162,10 @@ void init_last_index_table(void)
         last_index_table[3][i]  = get_last_index((U16)i) + 48;
     }
 }
+#endif
 
 
+#if !defined(USE_BB_POPCNT)
 //-------------------------------------------------------------------------------------------------
 //  Table used to calculate numbers of bits for a bitboard.
 //-------------------------------------------------------------------------------------------------
@@ -130,16 +177,7 @@ void init_count_table(void)
         bit_count_table[j] = get_bit_count(j);
     }
 }
-
-//-------------------------------------------------------------------------------------------------
-//  Return a bitboard for square index
-//  Square A8 = 0 and square H1 = 63.
-//-------------------------------------------------------------------------------------------------
-U64 square_bb(int index)
-{
-    assert(index >= 0 && index < 64);
-    return bb_square[index];
-}
+#endif
 
 //-------------------------------------------------------------------------------------------------
 //  Turn bit to 1 using index (0-63)
@@ -162,15 +200,6 @@ void bb_set_bit_rf(U64 *bb, int rank, int file)
     bb_set_bit(bb, rank * 8 + file);
 }
 
-//-------------------------------------------------------------------------------------------------
-//  Return TRUE if bit is 1
-//-------------------------------------------------------------------------------------------------
-int bb_is_one(U64 bb, int index)
-{
-    assert(index >= 0 && index < 64);
-    return bb & square_bb(index) ? TRUE : FALSE;
-}
-
 //-------------------------------------------------------------------------------------------------
 //  Turn bit to 0
 //-------------------------------------------------------------------------------------------------
@@ -195,7 +224,12 @@ U64 square_color_bb(int index)
 //-------------------------------------------------------------------------------------------------
 int bb_first(BBIX bbix)
 {
-#if defined(USE_BBIX_STRUCT)
+#if defined(USE_BB_BUILTIN) && defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanReverse64(&index, bbix.u64) ? 63 - (int)index : -1;
+#elif defined(USE_BB_BUILTIN)
+    return bbix.u64 ? __builtin_clzll(bbix.u64) : -1;
+#elif defined(USE_BBIX_STRUCT)
     if (bbix.u32[1]) {
         if (bbix.u16[3])
             return (int)first_index_table[0][bbix.u16[3]];
@@ -224,7 +258,12 @@ int bb_first(BBIX bbix)
 //-------------------------------------------------------------------------------------------------
 int bb_last(BBIX bbix)
 {
-#ifdef USE_BBIX_STRUCT
+#if defined(USE_BB_BUILTIN) && defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanForward64(&index, bbix.u64) ? 63 - (int)index : -1;
+#elif defined(USE_BB_BUILTIN)
+    return bbix.u64 ? 63 - __builtin_ctzll(bbix.u64) : -1;
+#elif defined(USE_BBIX_STRUCT)
     if (bbix.u32[0]) {
         if (bbix.u16[0])
             return (int)last_index_table[3][bbix.u16[0]];
@@ -253,7 +292,9 @@ int bb_last(BBIX bbix)
 //-------------------------------------------------------------------------------------------------
 int bb_count(BBIX bbix)
 {
-#ifdef USE_BBIX_STRUCT
+#if defined(USE_BB_POPCNT)
+    return bb_count_u64(bbix.u64);
+#elif defined(USE_BBIX_STRUCT)
     return (int)(bit_count_table[bbix.u16[0]] + bit_count_table[bbix.u16[1]] +
                  bit_count_table[bbix.u16[2]] + bit_count_table[bbix.u16[3]]);
 #else
@@ -269,10 +310,16 @@ int bb_count(BBIX bbix)
 //-------------------------------------------------------------------------------------------------
 int bb_count_u64(U64 bb)
 {
+#if defined(USE_BB_POPCNT) && defined(_MSC_VER)
+    return (int)__popcnt64(bb);
+#elif defined(USE_BB_POPCNT)
+    return __builtin_popcountll(bb);
+#else
     return bit_count_table[(bb & (U64)0xFFFF000000000000) >> 48] +
            bit_count_table[(bb & (U64)0x0000FFFF00000000) >> 32] +
            bit_count_table[(bb & (U64)0x00000000FFFF0000) >> 16] +
            bit_count_table[(bb & (U64)0x000000000000FFFF)];
+#endif
 }
 
 
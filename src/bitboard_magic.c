@@ -22,7 +22,16 @@ You can find the GNU General Public License at http://www.gnu.org/licenses/
 //  Magic numbers were generated using the example from chess programming wiki.
 //  Was adapted because tucano uses A8 = 0 and H1 = 63 for bitboard coordinates.
 //  It uses 64 bits implementation with no 32 bits optimization.
+//
+//  When compiled for BMI2 (-mbmi2 or -march=haswell) the table index is the PEXT of the
+//  occupancy with the mask instead of the magic multiply and shift. Tables have the same size.
+//  PEXT is slow on AMD processors before Zen 3: build with -DNO_PEXT to keep magics there.
 //-------------------------------------------------------------------------------------------------
+
+#if !defined(NO_PEXT) && (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define USE_PEXT
+#include <immintrin.h>
+#endif
 static const U64 rook_mask[64] =
 {
     ((U64)0x7E80808080808000),((U64)0x3E40404040404000),((U64)0x5E20202020202000),((U64)0x6E10101010101000),
@@ -43,6 +52,7 @@ static const U64 rook_mask[64] =
     ((U64)0x0008080808080876),((U64)0x000404040404047A),((U64)0x000202020202027C),((U64)0x000101010101017E),
 };
 
+#if !defined(USE_PEXT)
 static const U64 rook_magic[64] =
 {
     ((U64)0x200011004C002082),((U64)0x30008A083009008C),((U64)0x0802008408011002),((U64)0x0101000800041013),
@@ -75,6 +85,7 @@ static const int rook_shift[64] =
     53, 54, 54, 54, 54, 54, 54, 53,
     52, 53, 53, 53, 53, 53, 53, 52,
 };
+#endif
 
 static const U64 bishop_mask[64] =
 {
@@ -96,6 +107,7 @@ static const U64 bishop_mask[64] =
     ((U64)0x0000000040221400),((U64)0x0000004020100A00),((U64)0x0000402010080400),((U64)0x0040201008040200),
 };
 
+#if !defined(USE_PEXT)
 static const U64 bishop_magic[64] = 
 {
     ((U64)0x0002080200820206),((U64)0x0010081010420054),((U64)0x200020C002240102),((U64)0x0152030010820200),
@@ -127,6 +139,7 @@ static const int bishop_shift[64] =
     59, 59, 59, 59, 59, 59, 59, 59,
     58, 59, 59, 59, 59, 59, 59, 58,
 };
+#endif
 
 // Tables to hold all possible attack bitboards from each square.
 U64     rook_attack_table[102400];
@@ -150,7 +163,9 @@ void magic_init(void)
     int     sq;
     int     i;
     U64     result;
+#if !defined(USE_PEXT)
     int     index;
+#endif
     int     rook_max_index;
     int     bishop_max_index;
     int     rook_next_index = 0;
@@ -164,6 +179,22 @@ void magic_init(void)
         bishop_attack_start[sq] = bishop_next_index;
         rook_max_index = 0;
         bishop_max_index = 0;
+#if defined(USE_PEXT)
+        // init rook attacks: index bits are the mask bits from lowest to highest, as PEXT.
+        for (i = 0; i < (1 << count_1s(rook_mask[sq])); i++) {
+            result = convert_index_to_bb(i, rook_mask[sq]);
+            assert(_pext_u64(result, rook_mask[sq]) == (U64)i);
+            rook_attack_table[rook_attack_start[sq] + i] = generate_rook_attack(sq, result);
+            rook_max_index = i;
+        }
+        // init bishop attacks
+        for (i = 0; i < (1 << count_1s(bishop_mask[sq])); i++) {
+            result = convert_index_to_bb(i, bishop_mask[sq]);
+            assert(_pext_u64(result, bishop_mask[sq]) == (U64)i);
+            bishop_attack_table[bishop_attack_start[sq] + i] = generate_bishop_attack(sq, result);
+            bishop_max_index = i;
+        }
+#else
         // init rook attacks.
         for (i = 0; i < 4096; i++) {
             result = convert_index_to_bb(i, rook_mask[sq]);
@@ -178,11 +209,24 @@ void magic_init(void)
             bishop_attack_table[bishop_attack_start[sq] + index] = generate_bishop_attack(sq, result);
             bishop_max_index = MAX(bishop_max_index, index);
         }
+#endif
         rook_next_index += rook_max_index + 1;
         bishop_next_index += bishop_max_index + 1;
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Description of slider attacks implementation in use.
+//-------------------------------------------------------------------------------------------------
+char *magic_backend_name(void)
+{
+#if defined(USE_PEXT)
+    return "pext slider attacks";
+#else
+    return "magic slider attacks";
+#endif
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Calculate and return rook attack bitboard according occupancy bitboard.
 //-------------------------------------------------------------------------------------------------
@@ -190,7 +234,11 @@ U64 bb_rook_attacks(int sq, U64 occup)
 {
     int     index;
 
+#if defined(USE_PEXT)
+    index = (int)_pext_u64(occup, rook_mask[sq]);
+#else
     index = convert_bb_to_index(occup & rook_mask[sq], rook_magic[sq], rook_shift[sq]);
+#endif
     assert(index >= 0 && index < 4096);
     return rook_attack_table[rook_attack_start[sq] + index];
 }
@@ -202,7 +250,11 @@ U64 bb_bishop_attacks(int sq, U64 occup)
 {
     int     index;
     
+#if defined(USE_PEXT)
+    index = (int)_pext_u64(occup, bishop_mask[sq]);
+#else
     index = convert_bb_to_index(occup & bishop_mask[sq], bishop_magic[sq], bishop_shift[sq]);
+#endif
     assert(index >= 0 && index < 512);
     return bishop_attack_table[bishop_attack_start[sq] + index];
 }
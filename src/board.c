@@ -140,20 +140,16 @@ void set_fen(BOARD *board, char *fen)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Side on move
+//  Copy position to be searched by another game. Only the history since the last irreversible
+//  move is copied, and at least the last CONT_PLIES moves: it is used for repetition detection,
+//  the previous move and continuation history. Moves before it cannot be undone on the target.
 //-------------------------------------------------------------------------------------------------
-U8 side_on_move(BOARD *board)
+void copy_board(BOARD *target, BOARD *source)
 {
-    return board->side_on_move;
-}
+    memcpy(target, source, offsetof(BOARD, history));
 
-//-------------------------------------------------------------------------------------------------
-//  Get last move made on the board
-//-------------------------------------------------------------------------------------------------
-MOVE get_last_move_made(BOARD *board)
-{
-    if (board->histply == 0) return MOVE_NONE;
-    return board->history[board->histply - 1].move;
+    int first = MAX(0, source->histply - MAX(source->fifty_move_rule + 1, CONT_PLIES));
+    memcpy(&target->history[first], &source->history[first], sizeof(MOVE_HIST) * (source->histply - first));
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -175,6 +171,10 @@ void make_move(BOARD *board, MOVE move)
     board->history[board->histply].ep_square        = board->ep_square;
     board->history[board->histply].board_key        = board->key;
     board->history[board->histply].pawn_key         = board->pawn_key;
+    board->history[board->histply].material[WHITE]  = board->material[WHITE];
+    board->history[board->histply].material[BLACK]  = board->material[BLACK];
+    board->history[board->histply].pst[WHITE]       = board->pst[WHITE];
+    board->history[board->histply].pst[BLACK]       = board->pst[BLACK];
     board->history[board->histply].fifty_move_rule  = board->fifty_move_rule;
 
     // Key
@@ -295,6 +295,10 @@ void undo_move(BOARD *board)
     board->ep_square                 = board->history[board->histply].ep_square;
     board->key                       = board->history[board->histply].board_key;
     board->pawn_key                  = board->history[board->histply].pawn_key;
+    board->material[WHITE]           = board->history[board->histply].material[WHITE];
+    board->material[BLACK]           = board->history[board->histply].material[BLACK];
+    board->pst[WHITE]                = board->history[board->histply].pst[WHITE];
+    board->pst[BLACK]                = board->history[board->histply].pst[BLACK];
     board->fifty_move_rule           = board->history[board->histply].fifty_move_rule;
 
     //  basic move information
@@ -445,6 +449,7 @@ void move_piece(BOARD *board, int color, int type, int frsq, int tosq)
         board->pawn_key ^= zk_square(color, PAWN, frsq);
         board->pawn_key ^= zk_square(color, PAWN, tosq);
     }
+    board->pst[color] += PST_SCORE[color][type][tosq] - PST_SCORE[color][type][frsq];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -460,6 +465,8 @@ void set_piece(BOARD *board, int color, int type, int tosq)
     board->key ^= zk_square(color, type, tosq);
     if (type == PAWN) board->pawn_key ^= zk_square(color, PAWN, tosq);
     board->state[color].count[type]++;
+    board->material[color] += MATERIAL_SCORE[type];
+    board->pst[color] += PST_SCORE[color][type][tosq];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -475,6 +482,8 @@ void remove_piece(BOARD *board, int color, int type, int frsq)
     board->key ^= zk_square(color, type, frsq);
     if (type == PAWN) board->pawn_key ^= zk_square(color, PAWN, frsq);
     board->state[color].count[type]--;
+    board->material[color] -= MATERIAL_SCORE[type];
+    board->pst[color] -= PST_SCORE[color][type][frsq];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -530,257 +539,6 @@ int square_distance(int square1, int square2)
     return MAX(file_distance, rank_distance);
 }
 
-//-------------------------------------------------------------------------------------------------
-//  King BB
-//-------------------------------------------------------------------------------------------------
-U64 king_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[KING].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  King count
-//-------------------------------------------------------------------------------------------------
-int king_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].count[KING];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Queen BB
-//-------------------------------------------------------------------------------------------------
-U64 queen_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[QUEEN].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Queen count
-//-------------------------------------------------------------------------------------------------
-int queen_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].count[QUEEN];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Rook BB
-//-------------------------------------------------------------------------------------------------
-U64 rook_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[ROOK].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Rook count
-//-------------------------------------------------------------------------------------------------
-int rook_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].count[ROOK];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Bishop BB
-//-------------------------------------------------------------------------------------------------
-U64 bishop_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[BISHOP].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Bishop count
-//-------------------------------------------------------------------------------------------------
-int bishop_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].count[BISHOP];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Knight BB
-//-------------------------------------------------------------------------------------------------
-U64 knight_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[KNIGHT].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Knight count
-//-------------------------------------------------------------------------------------------------
-int knight_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].count[KNIGHT];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Pawn BB
-//-------------------------------------------------------------------------------------------------
-U64 pawn_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[PAWN].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Knight count
-//-------------------------------------------------------------------------------------------------
-int pawn_count(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    //return bb_count(board->state[color].piece[PAWN]);
-    return board->state[color].count[PAWN];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Occupied squares
-//-------------------------------------------------------------------------------------------------
-U64 occupied_bb(BOARD *board)
-{
-    return board->state[WHITE].all_pieces | board->state[BLACK].all_pieces;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Empty squares
-//-------------------------------------------------------------------------------------------------
-U64 empty_bb(BOARD *board)
-{
-    return ~(board->state[WHITE].all_pieces | board->state[BLACK].all_pieces);
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Queen and Bishop pieces
-//-------------------------------------------------------------------------------------------------
-U64 queen_bishop_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[QUEEN].u64 | board->state[color].piece[BISHOP].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Queen and Rook pieces
-//-------------------------------------------------------------------------------------------------
-U64 queen_rook_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].piece[QUEEN].u64 | board->state[color].piece[ROOK].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  King square
-//-------------------------------------------------------------------------------------------------
-int king_square(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].king_square;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Board key
-//-------------------------------------------------------------------------------------------------
-U64 board_key(BOARD *board)
-{
-    return board->key;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Board pawn key
-//-------------------------------------------------------------------------------------------------
-U64 board_pawn_key(BOARD *board)
-{
-    return board->pawn_key;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Piece on square
-//-------------------------------------------------------------------------------------------------
-int piece_on_square(BOARD *board, int color, int square)
-{
-    assert(color == WHITE || color == BLACK);
-    assert(square >= 0 && square < 64);
-    return board->state[color].square[square];
-}
-
-//-------------------------------------------------------------------------------------------------
-//  All Pieces
-//-------------------------------------------------------------------------------------------------
-U64 all_pieces_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return board->state[color].all_pieces;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  QRNB Pieces
-//-------------------------------------------------------------------------------------------------
-U64 qrnb_bb(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    return queen_bb(board, color) | rook_bb(board, color) | knight_bb(board, color) | bishop_bb(board, color);
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Piece bitboard
-//-------------------------------------------------------------------------------------------------
-U64 piece_bb(BOARD *board, int color, int piece)
-{
-    assert(valid_color(color));
-    assert(piece >= PAWN && piece <= KING);
-    return board->state[color].piece[piece].u64;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Has pieces (rook, queen, bishop, knight)
-//-------------------------------------------------------------------------------------------------
-int has_pieces(BOARD *board, int color)
-{
-    assert(valid_color(color));
-    if (board->state[color].piece[QUEEN].u64 || board->state[color].piece[ROOK].u64)
-        return TRUE;
-    if (board->state[color].piece[BISHOP].u64 || board->state[color].piece[KNIGHT].u64)
-        return TRUE;
-    return FALSE;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Ep square bitboard
-//-------------------------------------------------------------------------------------------------
-U64 ep_square_bb(BOARD *board)
-{
-    return board->ep_square != 0 ? square_bb(board->ep_square) : 0;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Ep square
-//-------------------------------------------------------------------------------------------------
-int ep_square(BOARD *board)
-{
-    return board->ep_square;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Return flag for king side castle move
-//-------------------------------------------------------------------------------------------------
-int can_castle_ks_flag(BOARD *board, int color)
-{
-    return board->state[color].can_castle_ks;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Return flag for queen side castle move
-//-------------------------------------------------------------------------------------------------
-int can_castle_qs_flag(BOARD *board, int color)
-{
-    return board->state[color].can_castle_qs;
-}
-
 //-------------------------------------------------------------------------------------------------
 //  Can generate king side castle move
 //-------------------------------------------------------------------------------------------------
@@ -815,24 +573,6 @@ int can_generate_castle_qs(BOARD *board, int color)
     return FALSE;
 }
 
-//-------------------------------------------------------------------------------------------------
-//  board data
-//-------------------------------------------------------------------------------------------------
-void set_ply(BOARD *board, U16 value)
-{
-    board->ply = value;
-}
-
-U16 get_ply(BOARD *board)
-{
-    return board->ply;
-}
-
-U16 get_history_ply(BOARD *board)
-{
-    return board->histply;
-}
-
 //-------------------------------------------------------------------------------------------------
 //  Get the number of moves played by color
 //-------------------------------------------------------------------------------------------------
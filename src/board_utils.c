@@ -60,24 +60,6 @@ char promo_letter(int piece)
     return PROMO_LETTER[piece];
 }
 
-//-------------------------------------------------------------------------------------------------
-//  Return rank (0-7) from a square (0-63)
-//-------------------------------------------------------------------------------------------------
-int get_rank(int square)
-{
-    assert(square >= 0 && square <= 63);
-    return square >> 3;
-}
-
-//-------------------------------------------------------------------------------------------------
-//  Return file (0-7) from a square (0-63)
-//-------------------------------------------------------------------------------------------------
-int get_file(int square)
-{
-    assert(square >= 0 && square <= 63);
-    return square & 0x07;
-}
-
 //-------------------------------------------------------------------------------------------------
 //  Return square (0-63) from rank (0-7) and file (0-7)
 //-------------------------------------------------------------------------------------------------
@@ -315,8 +297,6 @@ void print_current_moves(GAME *game)
     select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), MOVE_NONE, 0);
 
     while ((move = next_move(&ml)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, ml.pins, move))
-            continue;
         if (!is_valid(&game->board, move)) {
             util_print_move(move, 1);
             board_print(&game->board, "invalid_move");
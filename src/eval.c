@@ -22,7 +22,7 @@
 //-------------------------------------------------------------------------------------------------
 
 void    eval_material(BOARD *board, EVALUATION *eval_values);
-void    eval_pawns(BOARD *board, PAWN_TABLE *pawn_table, EVALUATION *eval_values);
+void    eval_pawns(BOARD *board, PAWN_CACHE *pawn_cache, EVALUATION *eval_values);
 void    eval_passed(BOARD *board, EVALUATION *eval_values);
 void    eval_kings(BOARD *board, EVALUATION *eval_values);
 void    eval_pieces(BOARD *board, EVALUATION *eval_values);
@@ -35,15 +35,21 @@ int USE_EVAL_TABLE = TRUE;
 int evaluate(GAME *game, int alpha, int beta)
 {
     //  Return score from eval table if available.
-    EVAL_TABLE *pet = game->eval_table + (board_key(&game->board) % EVAL_TABLE_SIZE);
-    if (USE_EVAL_TABLE && pet->key == board_key(&game->board) && !EVAL_PRINTING) {
-        return pet->score;
+    EVAL_TABLE *pet = game->eval_cache.table + (board_key(&game->board) & game->eval_cache.mask);
+    if (USE_EVAL_TABLE && !EVAL_PRINTING) {
+        game->eval_cache.probes++;
+        if (pet->key == CACHE_KEY(board_key(&game->board))) {
+            game->eval_cache.hits++;
+            return pet->score;
+        }
     }
 
     //  Prepare eval_values.
     EVALUATION eval_values;
     eval_values.phase = 0;
     eval_values.material[WHITE] = eval_values.material[BLACK] = 0;
+    eval_values.pst[WHITE] = game->board.pst[WHITE];
+    eval_values.pst[BLACK] = game->board.pst[BLACK];
     eval_values.pawn[WHITE] = eval_values.pawn[BLACK] = 0;
     eval_values.king[WHITE] = eval_values.king[BLACK] = 0;
     eval_values.passed[WHITE] = eval_values.passed[BLACK] = 0;
@@ -53,16 +59,33 @@ int evaluate(GAME *game, int alpha, int beta)
     eval_values.flag_king_safety[WHITE] = eval_values.flag_king_safety[BLACK] = 0;
     eval_values.bb_passers[WHITE] = eval_values.bb_passers[BLACK] = 0;
 
+    assert(valid_eval_accumulators(&game->board));
+
     //  Material.
     eval_material(&game->board, &eval_values);
 
     //  Position is draw.
     if (USE_EVAL_TABLE && eval_values.draw_adjust == 0) {
-        pet->key = board_key(&game->board);
+        pet->key = CACHE_KEY(board_key(&game->board));
         pet->score = 0;
         return 0;
     }
 
+    //  Network evaluation, with the same draw adjustment from material.
+    if (nnue_is_loaded()) {
+        int score = nnue_evaluate(game) * eval_values.draw_adjust / 64;
+
+        if (score > MAX_EVAL) score = MAX_EVAL;
+        if (score < -MAX_EVAL) score = -MAX_EVAL;
+
+        if (USE_EVAL_TABLE) {
+            pet->key = CACHE_KEY(board_key(&game->board));
+            pet->score = score;
+        }
+        if (EVAL_PRINTING) printf("NNUE evaluation (%s)\nDraw Adjustment : %d\n", nnue_simd_name(), eval_values.draw_adjust);
+        return score;
+    }
+
     // Lazy evaluation. If there's a big material difference return early.
     int opening = OPENING(eval_values.material[WHITE]) - OPENING(eval_values.material[BLACK]);
     int endgame = ENDGAME(eval_values.material[WHITE]) - ENDGAME(eval_values.material[BLACK]);
@@ -79,7 +102,7 @@ int evaluate(GAME *game, int alpha, int beta)
     if (lazy_eval + 800 < alpha || lazy_eval - 800 > beta) return lazy_eval;
 
     //  Evaluation.
-    eval_pawns(&game->board, game->pawn_table, &eval_values);
+    eval_pawns(&game->board, &game->pawn_cache, &eval_values);
     eval_passed(&game->board, &eval_values);
     eval_kings(&game->board, &eval_values);
     eval_pieces(&game->board, &eval_values);
@@ -90,6 +113,9 @@ int evaluate(GAME *game, int alpha, int beta)
     opening += OPENING(eval_values.material[WHITE]) - OPENING(eval_values.material[BLACK]);
     endgame += ENDGAME(eval_values.material[WHITE]) - ENDGAME(eval_values.material[BLACK]);
 
+    opening += OPENING(eval_values.pst[WHITE]) - OPENING(eval_values.pst[BLACK]);
+    endgame += ENDGAME(eval_values.pst[WHITE]) - ENDGAME(eval_values.pst[BLACK]);
+
     opening += OPENING(eval_values.king[WHITE]) - OPENING(eval_values.king[BLACK]);
     endgame += ENDGAME(eval_values.king[WHITE]) - ENDGAME(eval_values.king[BLACK]);
 
@@ -126,7 +152,7 @@ int evaluate(GAME *game, int alpha, int beta)
 
     //  Save to eval table and return.
     if (USE_EVAL_TABLE) {
-        pet->key = board_key(&game->board);
+        pet->key = CACHE_KEY(board_key(&game->board));
         pet->score = score;
     }
 
@@ -52,9 +52,6 @@ void eval_kings(BOARD *board, EVALUATION *eval_values)
         assert(file >= 0 && file <= 7);
         assert(rank >= 0 && rank <= 7);
 
-        // king pst
-        eval_values->king[myc] += eval_pst_king(myc, pcsq);
-
         // bonus for staying close to pawns on one side of the board in end games.
         if ((pawns | BB_FILES_QS) == BB_FILES_QS)
             eval_values->king[myc] += B_PAWN_PROXIMITY * (4 - file);
@@ -85,18 +85,9 @@ void eval_material(BOARD *board, EVALUATION *eval_values)
     if (bq >= 1 && (br + bb + bn) >= 1)
         eval_values->flag_king_safety[WHITE] = TRUE;
 
-    eval_values->material[WHITE] = wq * SCORE_QUEEN
-                                 + wr * SCORE_ROOK
-                                 + wb * SCORE_BISHOP
-                                 + wn * SCORE_KNIGHT
-                                 + wp * SCORE_PAWN
-                                 + (wb >= 2 ? B_BISHOP_PAIR : 0);
-    eval_values->material[BLACK] = bq * SCORE_QUEEN
-                                 + br * SCORE_ROOK
-                                 + bb * SCORE_BISHOP
-                                 + bn * SCORE_KNIGHT
-                                 + bp * SCORE_PAWN
-                                 + (bb >= 2 ? B_BISHOP_PAIR : 0);
+    //  Piece values are updated incrementally by the board.
+    eval_values->material[WHITE] = board->material[WHITE] + (wb >= 2 ? B_BISHOP_PAIR : 0);
+    eval_values->material[BLACK] = board->material[BLACK] + (bb >= 2 ? B_BISHOP_PAIR : 0);
 
     //  Calculate game phase based on piece values.
     //  Opening = 0, Endgame = 48
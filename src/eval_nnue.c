@@ -0,0 +1,587 @@
+/*-------------------------------------------------------------------------------
+  tucano is a XBoard chess playing engine developed by Alcides Schulz.
+  Copyright (C) 2011-present - Alcides Schulz
+
+  tucano is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tucano is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You can find the GNU General Public License at http://www.gnu.org/licenses/
+-------------------------------------------------------------------------------*/
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define USE_MMAP
+#endif
+
+#include "globals.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_SIMD "AVX2"
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define NNUE_SIMD "SSE4.1"
+#else
+#define NNUE_SIMD "scalar"
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//  NNUE evaluation: efficiently updatable neural network in the HalfKP 41024->256x2-32-32-1
+//  format (Stockfish 12 network files). Input features are (king square, piece, square) for
+//  each side's point of view. The first layer output (accumulator) is updated with the pieces
+//  changed by the moves, the other layers are small and calculated at each evaluation.
+//
+//  Accumulators are kept per ply in GAME and identified by the board key. When evaluating, the
+//  nearest ancestor with a valid accumulator is found in the move history and the moves made
+//  after it are applied. A king move requires a full refresh for that side's point of view.
+//-------------------------------------------------------------------------------------------------
+
+#define NNUE_VERSION        0x7AF32F16
+#define NNUE_PIECE_SQUARES  641                 // 10 piece types * 64 squares + 1
+#define NNUE_INPUTS         (64 * NNUE_PIECE_SQUARES)
+#define NNUE_L1             (NNUE_HALF_DIMS * 2)
+#define NNUE_L2             32
+#define NNUE_L3             32
+#define NNUE_SHIFT          6                   // weight scale bits of hidden layers
+#define NNUE_SCALE          16                  // output scale
+#define NNUE_MAX_UPDATES    16                  // moves applied before a full refresh is cheaper
+#define NNUE_MAX_FEATURES   32
+
+//  Network parameters. Feature transformer weights stay in the mapped file.
+S16     nnue_ft_biases[NNUE_HALF_DIMS];
+S16     *nnue_ft_weights = NULL;
+S32     nnue_l1_biases[NNUE_L2];
+S8      nnue_l1_weights[NNUE_L2 * NNUE_L1];
+S32     nnue_l2_biases[NNUE_L3];
+S8      nnue_l2_weights[NNUE_L3 * NNUE_L2];
+S32     nnue_out_bias;
+S8      nnue_out_weights[NNUE_L3];
+
+int     nnue_loaded = FALSE;
+int     nnue_net_id = 0;
+
+//  File mapping
+void    *nnue_data = NULL;
+size_t  nnue_data_size = 0;
+#if defined(_WIN32) || defined(_WIN64)
+HANDLE  nnue_file_handle = NULL;
+HANDLE  nnue_map_handle = NULL;
+#endif
+
+//  Features changed by a move for one point of view.
+typedef struct s_nnue_changes {
+    int     removed[3];
+    int     added[3];
+    int     removed_count;
+    int     added_count;
+}   NNUE_CHANGES;
+
+void    *nnue_map_file(char *file_name, size_t *size);
+void    nnue_unmap_file(void);
+int     nnue_read_network(U8 *data, size_t size);
+int     nnue_feature_index(int view, int king_square, int color, int piece, int square);
+void    nnue_refresh(BOARD *board, NNUE_ACCUMULATOR *acc, int view);
+int     nnue_move_changes(MOVE move, int mover, int view, int king_square, NNUE_CHANGES *changes);
+void    nnue_apply_changes(NNUE_ACCUMULATOR *acc, int view, NNUE_CHANGES *changes);
+NNUE_ACCUMULATOR *nnue_update_accumulator(GAME *game);
+int     nnue_forward(NNUE_ACCUMULATOR *acc, int side);
+void    nnue_add_row(S16 *values, int feature);
+void    nnue_sub_row(S16 *values, int feature);
+void    nnue_affine(U8 *input, int input_size, S8 *weights, S32 *biases, int output_size, S32 *output);
+
+//-------------------------------------------------------------------------------------------------
+//  Load network file. An empty name (or "<empty>") unloads the network and the classical
+//  evaluation is used. Returns TRUE if a network is loaded.
+//-------------------------------------------------------------------------------------------------
+int nnue_load(char *file_name)
+{
+    nnue_loaded = FALSE;
+    nnue_unmap_file();
+    nnue_net_id++;
+
+    if (file_name == NULL || file_name[0] == '\0' || !strcmp(file_name, "<empty>")) return FALSE;
+
+    size_t size = 0;
+    U8 *data = (U8 *)nnue_map_file(file_name, &size);
+    if (data == NULL) {
+        fprintf(stderr, "nnue_load: cannot open file %s\n", file_name);
+        return FALSE;
+    }
+    if (!nnue_read_network(data, size)) {
+        fprintf(stderr, "nnue_load: invalid network file %s\n", file_name);
+        nnue_unmap_file();
+        return FALSE;
+    }
+    nnue_loaded = TRUE;
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Indicates if NNUE evaluation is active.
+//-------------------------------------------------------------------------------------------------
+int nnue_is_loaded(void)
+{
+    return nnue_loaded;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Name of the instruction set used for inference.
+//-------------------------------------------------------------------------------------------------
+char *nnue_simd_name(void)
+{
+    return NNUE_SIMD;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Map network file into memory (read only). The pages are shared by all engine processes.
+//-------------------------------------------------------------------------------------------------
+void *nnue_map_file(char *file_name, size_t *size)
+{
+#if defined(USE_MMAP)
+    int fd = open(file_name, O_RDONLY);
+    if (fd == -1) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    nnue_data = data;
+    nnue_data_size = *size = (size_t)st.st_size;
+    return data;
+#elif defined(_WIN32) || defined(_WIN64)
+    nnue_file_handle = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (nnue_file_handle == INVALID_HANDLE_VALUE) {
+        nnue_file_handle = NULL;
+        return NULL;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(nnue_file_handle, &file_size);
+    nnue_map_handle = CreateFileMappingA(nnue_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (nnue_map_handle == NULL) {
+        nnue_unmap_file();
+        return NULL;
+    }
+    nnue_data = MapViewOfFile(nnue_map_handle, FILE_MAP_READ, 0, 0, 0);
+    if (nnue_data == NULL) {
+        nnue_unmap_file();
+        return NULL;
+    }
+    nnue_data_size = *size = (size_t)file_size.QuadPart;
+    return nnue_data;
+#else
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    nnue_data = file_size > 0 ? malloc((size_t)file_size) : NULL;
+    if (nnue_data == NULL || fread(nnue_data, 1, (size_t)file_size, file) != (size_t)file_size) {
+        fclose(file);
+        nnue_unmap_file();
+        return NULL;
+    }
+    fclose(file);
+    nnue_data_size = *size = (size_t)file_size;
+    return nnue_data;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Release network file mapping.
+//-------------------------------------------------------------------------------------------------
+void nnue_unmap_file(void)
+{
+#if defined(USE_MMAP)
+    if (nnue_data != NULL) munmap(nnue_data, nnue_data_size);
+#elif defined(_WIN32) || defined(_WIN64)
+    if (nnue_data != NULL) UnmapViewOfFile(nnue_data);
+    if (nnue_map_handle != NULL) CloseHandle(nnue_map_handle);
+    if (nnue_file_handle != NULL) CloseHandle(nnue_file_handle);
+    nnue_map_handle = nnue_file_handle = NULL;
+#else
+    if (nnue_data != NULL) free(nnue_data);
+#endif
+    nnue_data = NULL;
+    nnue_data_size = 0;
+    nnue_ft_weights = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Read little endian values from network data.
+//-------------------------------------------------------------------------------------------------
+U32 nnue_read_u32(U8 *data)
+{
+    return (U32)data[0] | ((U32)data[1] << 8) | ((U32)data[2] << 16) | ((U32)data[3] << 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Validate file layout and set network parameters.
+//-------------------------------------------------------------------------------------------------
+int nnue_read_network(U8 *data, size_t size)
+{
+    if (size < 12 || nnue_read_u32(data) != NNUE_VERSION) return FALSE;
+
+    size_t desc_size = nnue_read_u32(data + 8);
+    size_t expected = 12 + desc_size
+                    + 4 + NNUE_HALF_DIMS * 2 + (size_t)NNUE_INPUTS * NNUE_HALF_DIMS * 2
+                    + 4 + NNUE_L2 * 4 + NNUE_L2 * NNUE_L1 + NNUE_L3 * 4 + NNUE_L3 * NNUE_L2 + 4 + NNUE_L3;
+    if (size != expected) return FALSE;
+
+    U8 *p = data + 12 + desc_size;
+
+    // feature transformer: hash, biases, weights
+    p += 4;
+    for (int i = 0; i < NNUE_HALF_DIMS; i++, p += 2) nnue_ft_biases[i] = (S16)(p[0] | (p[1] << 8));
+    nnue_ft_weights = (S16 *)p;
+    p += (size_t)NNUE_INPUTS * NNUE_HALF_DIMS * 2;
+
+    // network: hash, then layers from input to output (biases followed by weights)
+    p += 4;
+    for (int i = 0; i < NNUE_L2; i++, p += 4) nnue_l1_biases[i] = (S32)nnue_read_u32(p);
+    memcpy(nnue_l1_weights, p, sizeof(nnue_l1_weights));
+    p += sizeof(nnue_l1_weights);
+    for (int i = 0; i < NNUE_L3; i++, p += 4) nnue_l2_biases[i] = (S32)nnue_read_u32(p);
+    memcpy(nnue_l2_weights, p, sizeof(nnue_l2_weights));
+    p += sizeof(nnue_l2_weights);
+    nnue_out_bias = (S32)nnue_read_u32(p);
+    p += 4;
+    memcpy(nnue_out_weights, p, sizeof(nnue_out_weights));
+
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Feature index for a piece (not king) from one side's point of view. Network squares start
+//  at A1 and are rotated for black.
+//-------------------------------------------------------------------------------------------------
+int nnue_feature_index(int view, int king_square, int color, int piece, int square)
+{
+    int orient = view == WHITE ? 56 : 7;
+    int piece_index = 1 + (piece * 2 + (color != view)) * 64;
+
+    return (king_square ^ orient) * NNUE_PIECE_SQUARES + piece_index + (square ^ orient);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Calculate accumulator for one point of view from all pieces on the board.
+//-------------------------------------------------------------------------------------------------
+void nnue_refresh(BOARD *board, NNUE_ACCUMULATOR *acc, int view)
+{
+    int king_sq = king_square(board, view);
+
+    memcpy(acc->values[view], nnue_ft_biases, sizeof(nnue_ft_biases));
+    for (int color = WHITE; color <= BLACK; color++) {
+        for (int piece = PAWN; piece <= QUEEN; piece++) {
+            BBIX pieces;
+            pieces.u64 = piece_bb(board, color, piece);
+            while (pieces.u64) {
+                int square = bb_first(pieces);
+                nnue_add_row(acc->values[view], nnue_feature_index(view, king_sq, color, piece, square));
+                bb_clear_bit(&pieces.u64, square);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Features removed and added by a move for one point of view. Returns FALSE when the king of
+//  this point of view moved and the accumulator must be refreshed.
+//-------------------------------------------------------------------------------------------------
+int nnue_move_changes(MOVE move, int mover, int view, int king_square, NNUE_CHANGES *changes)
+{
+    int type = unpack_type(move);
+    int piece = unpack_piece(move);
+    int from = unpack_from(move);
+    int to = unpack_to(move);
+    int opp = flip_color(mover);
+
+    changes->removed_count = changes->added_count = 0;
+
+    if (type == MT_NULL) return TRUE;
+    if (piece == KING && mover == view) return FALSE;
+
+#define NNUE_REMOVE(c,p,s)  changes->removed[changes->removed_count++] = nnue_feature_index(view, king_square, c, p, s)
+#define NNUE_ADD(c,p,s)     changes->added[changes->added_count++] = nnue_feature_index(view, king_square, c, p, s)
+
+    switch (type) {
+        case MT_CAPPC:
+            NNUE_REMOVE(opp, unpack_capture(move), to);
+            // fall through
+        case MT_QUIET:
+        case MT_PAWN2:
+            if (piece != KING) {
+                NNUE_REMOVE(mover, piece, from);
+                NNUE_ADD(mover, piece, to);
+            }
+            break;
+        case MT_EPCAP:
+            NNUE_REMOVE(opp, PAWN, unpack_ep_pawn_square(move));
+            NNUE_REMOVE(mover, PAWN, from);
+            NNUE_ADD(mover, PAWN, to);
+            break;
+        case MT_CPPRM:
+            NNUE_REMOVE(opp, unpack_capture(move), to);
+            // fall through
+        case MT_PROMO:
+            NNUE_REMOVE(mover, PAWN, from);
+            NNUE_ADD(mover, unpack_prom_piece(move), to);
+            break;
+        case MT_CSWKS:
+            NNUE_REMOVE(WHITE, ROOK, H1);
+            NNUE_ADD(WHITE, ROOK, F1);
+            break;
+        case MT_CSWQS:
+            NNUE_REMOVE(WHITE, ROOK, A1);
+            NNUE_ADD(WHITE, ROOK, D1);
+            break;
+        case MT_CSBKS:
+            NNUE_REMOVE(BLACK, ROOK, H8);
+            NNUE_ADD(BLACK, ROOK, F8);
+            break;
+        case MT_CSBQS:
+            NNUE_REMOVE(BLACK, ROOK, A8);
+            NNUE_ADD(BLACK, ROOK, D8);
+            break;
+    }
+
+#undef NNUE_REMOVE
+#undef NNUE_ADD
+
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Apply feature changes to the accumulator of one point of view.
+//-------------------------------------------------------------------------------------------------
+void nnue_apply_changes(NNUE_ACCUMULATOR *acc, int view, NNUE_CHANGES *changes)
+{
+    for (int i = 0; i < changes->removed_count; i++) nnue_sub_row(acc->values[view], changes->removed[i]);
+    for (int i = 0; i < changes->added_count; i++) nnue_add_row(acc->values[view], changes->added[i]);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Get the accumulator for current position. It is searched backwards through the move history
+//  for a computed accumulator, then the moves made after it are applied.
+//-------------------------------------------------------------------------------------------------
+NNUE_ACCUMULATOR *nnue_update_accumulator(GAME *game)
+{
+    BOARD   *board = &game->board;
+    int     ply = MIN(get_ply(board), MAX_PLY);
+    NNUE_ACCUMULATOR *acc = &game->nnue_stack[ply];
+
+    if (acc->key == board_key(board) && acc->net_id == nnue_net_id) return acc;
+
+    //  Find nearest position with a computed accumulator.
+    int back = 0;
+    int found = FALSE;
+    if (ply == get_ply(board)) {
+        int max_back = MIN(MIN(ply, board->histply), NNUE_MAX_UPDATES);
+        for (back = 1; back <= max_back; back++) {
+            NNUE_ACCUMULATOR *prev = &game->nnue_stack[ply - back];
+            if (prev->net_id == nnue_net_id && prev->key == board->history[board->histply - back].board_key) {
+                found = TRUE;
+                break;
+            }
+        }
+    }
+
+    //  Apply the moves made after the computed position. Kings moved are refreshed.
+    int refresh[COLORS] = {TRUE, TRUE};
+    if (found) {
+        NNUE_ACCUMULATOR *prev = &game->nnue_stack[ply - back];
+        memcpy(acc->values, prev->values, sizeof(acc->values));
+        refresh[WHITE] = refresh[BLACK] = FALSE;
+        for (int view = WHITE; view <= BLACK; view++) {
+            int king_sq = king_square(board, view);
+            for (int i = back; i > 0 && !refresh[view]; i--) {
+                NNUE_CHANGES changes;
+                MOVE move = board->history[board->histply - i].move;
+                int mover = (i & 1) ? flip_color(side_on_move(board)) : side_on_move(board);
+                if (!nnue_move_changes(move, mover, view, king_sq, &changes))
+                    refresh[view] = TRUE;
+                else
+                    nnue_apply_changes(acc, view, &changes);
+            }
+        }
+    }
+
+    if (refresh[WHITE]) nnue_refresh(board, acc, WHITE);
+    if (refresh[BLACK]) nnue_refresh(board, acc, BLACK);
+
+    acc->key = board_key(board);
+    acc->net_id = nnue_net_id;
+    return acc;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Evaluate current position using the network. Score is from side on move point of view.
+//-------------------------------------------------------------------------------------------------
+int nnue_evaluate(GAME *game)
+{
+    NNUE_ACCUMULATOR *acc = nnue_update_accumulator(game);
+
+    assert(nnue_accumulator_is_ok(game, acc));
+
+    return nnue_forward(acc, side_on_move(&game->board));
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Network layers: clipped accumulator (side on move first), two hidden layers and output.
+//-------------------------------------------------------------------------------------------------
+int nnue_forward(NNUE_ACCUMULATOR *acc, int side)
+{
+    U8      input[NNUE_L1];
+    U8      hidden1[NNUE_L2];
+    U8      hidden2[NNUE_L3];
+    S32     output[NNUE_L3];
+    int     views[2] = {side, flip_color(side)};
+
+    for (int v = 0; v < 2; v++) {
+        S16 *values = acc->values[views[v]];
+        U8 *out = &input[v * NNUE_HALF_DIMS];
+#if defined(__AVX2__)
+        for (int i = 0; i < NNUE_HALF_DIMS; i += 32) {
+            __m256i a = _mm256_loadu_si256((__m256i *)&values[i]);
+            __m256i b = _mm256_loadu_si256((__m256i *)&values[i + 16]);
+            __m256i packed = _mm256_packs_epi16(a, b);
+            packed = _mm256_max_epi8(packed, _mm256_setzero_si256());
+            packed = _mm256_permute4x64_epi64(packed, 0xD8);
+            _mm256_storeu_si256((__m256i *)&out[i], packed);
+        }
+#elif defined(__SSE4_1__)
+        for (int i = 0; i < NNUE_HALF_DIMS; i += 16) {
+            __m128i a = _mm_loadu_si128((__m128i *)&values[i]);
+            __m128i b = _mm_loadu_si128((__m128i *)&values[i + 8]);
+            __m128i packed = _mm_max_epi8(_mm_packs_epi16(a, b), _mm_setzero_si128());
+            _mm_storeu_si128((__m128i *)&out[i], packed);
+        }
+#else
+        for (int i = 0; i < NNUE_HALF_DIMS; i++) {
+            out[i] = (U8)MAX(0, MIN(127, values[i]));
+        }
+#endif
+    }
+
+    nnue_affine(input, NNUE_L1, nnue_l1_weights, nnue_l1_biases, NNUE_L2, output);
+    for (int i = 0; i < NNUE_L2; i++) hidden1[i] = (U8)MAX(0, MIN(127, output[i] >> NNUE_SHIFT));
+
+    nnue_affine(hidden1, NNUE_L2, nnue_l2_weights, nnue_l2_biases, NNUE_L3, output);
+    for (int i = 0; i < NNUE_L3; i++) hidden2[i] = (U8)MAX(0, MIN(127, output[i] >> NNUE_SHIFT));
+
+    nnue_affine(hidden2, NNUE_L3, nnue_out_weights, &nnue_out_bias, 1, output);
+
+    return output[0] / NNUE_SCALE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Affine layer with 8 bit inputs and weights: output = biases + weights * input. Input size
+//  is a multiple of 32.
+//-------------------------------------------------------------------------------------------------
+void nnue_affine(U8 *input, int input_size, S8 *weights, S32 *biases, int output_size, S32 *output)
+{
+    for (int o = 0; o < output_size; o++) {
+        S8 *row = &weights[o * input_size];
+#if defined(__AVX2__)
+        __m256i sum = _mm256_setzero_si256();
+        __m256i ones = _mm256_set1_epi16(1);
+        for (int i = 0; i < input_size; i += 32) {
+            __m256i product = _mm256_maddubs_epi16(_mm256_loadu_si256((__m256i *)&input[i]), _mm256_loadu_si256((__m256i *)&row[i]));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, ones));
+        }
+        __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4E));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(sum128);
+#elif defined(__SSE4_1__)
+        __m128i sum = _mm_setzero_si128();
+        __m128i ones = _mm_set1_epi16(1);
+        for (int i = 0; i < input_size; i += 16) {
+            __m128i product = _mm_maddubs_epi16(_mm_loadu_si128((__m128i *)&input[i]), _mm_loadu_si128((__m128i *)&row[i]));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(product, ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(sum);
+#else
+        S32 sum = biases[o];
+        for (int i = 0; i < input_size; i++) sum += input[i] * row[i];
+        output[o] = sum;
+#endif
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Add/subtract feature transformer weights of one feature to the accumulator.
+//-------------------------------------------------------------------------------------------------
+void nnue_add_row(S16 *values, int feature)
+{
+    S16 *row = &nnue_ft_weights[(size_t)feature * NNUE_HALF_DIMS];
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HALF_DIMS; i += 16) {
+        __m256i v = _mm256_loadu_si256((__m256i *)&values[i]);
+        _mm256_storeu_si256((__m256i *)&values[i], _mm256_add_epi16(v, _mm256_loadu_si256((__m256i *)&row[i])));
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < NNUE_HALF_DIMS; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i *)&values[i]);
+        _mm_storeu_si128((__m128i *)&values[i], _mm_add_epi16(v, _mm_loadu_si128((__m128i *)&row[i])));
+    }
+#else
+    S16 weights[NNUE_HALF_DIMS];
+    memcpy(weights, row, sizeof(weights));  // file data may not be aligned
+    for (int i = 0; i < NNUE_HALF_DIMS; i++) values[i] += weights[i];
+#endif
+}
+
+void nnue_sub_row(S16 *values, int feature)
+{
+    S16 *row = &nnue_ft_weights[(size_t)feature * NNUE_HALF_DIMS];
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HALF_DIMS; i += 16) {
+        __m256i v = _mm256_loadu_si256((__m256i *)&values[i]);
+        _mm256_storeu_si256((__m256i *)&values[i], _mm256_sub_epi16(v, _mm256_loadu_si256((__m256i *)&row[i])));
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < NNUE_HALF_DIMS; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i *)&values[i]);
+        _mm_storeu_si128((__m128i *)&values[i], _mm_sub_epi16(v, _mm_loadu_si128((__m128i *)&row[i])));
+    }
+#else
+    S16 weights[NNUE_HALF_DIMS];
+    memcpy(weights, row, sizeof(weights));  // file data may not be aligned
+    for (int i = 0; i < NNUE_HALF_DIMS; i++) values[i] -= weights[i];
+#endif
+}
+
+#ifndef NDEBUG
+//-------------------------------------------------------------------------------------------------
+//  Incremental accumulator is the same as a full refresh.
+//-------------------------------------------------------------------------------------------------
+int nnue_accumulator_is_ok(GAME *game, NNUE_ACCUMULATOR *acc)
+{
+    NNUE_ACCUMULATOR full;
+
+    nnue_refresh(&game->board, &full, WHITE);
+    nnue_refresh(&game->board, &full, BLACK);
+    if (memcmp(full.values, acc->values, sizeof(full.values))) {
+        printf("nnue accumulator error\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+#endif
+
+//END
@@ -23,24 +23,30 @@
 
 int is_candidate(BOARD *board, int myc, int pcsq);
 int space_bonus(BOARD *board, int myc);
+U8  passer_files(U64 passers);
+U64 passers_from_files(BOARD *board, int myc, U8 files);
 
 int USE_PAWN_TABLE = TRUE;
 
 //------------------------------------------------------------------------------------
 //    Evaluate pawns and indicate what pawns are passed to be evaluated later.
 //------------------------------------------------------------------------------------
-void eval_pawns(BOARD *board, PAWN_TABLE *pawn_table, EVALUATION *eval_values)
+void eval_pawns(BOARD *board, PAWN_CACHE *pawn_cache, EVALUATION *eval_values)
 {
     BBIX        pawns;
     
     // Probe pawn evaluation table.
-    PAWN_TABLE *ppt = pawn_table + (board_pawn_key(board) % PAWN_TABLE_SIZE);
-    if (USE_PAWN_TABLE && board_pawn_key(board) != 0 && ppt->key == board_pawn_key(board) && !EVAL_PRINTING) {
-        eval_values->pawn[WHITE] = ppt->pawn_eval[WHITE];
-        eval_values->pawn[BLACK] = ppt->pawn_eval[BLACK];
-        eval_values->bb_passers[WHITE] = ppt->bb_passers[WHITE];
-        eval_values->bb_passers[BLACK] = ppt->bb_passers[BLACK];
-        return;
+    PAWN_TABLE *ppt = pawn_cache->table + (board_pawn_key(board) & pawn_cache->mask);
+    if (USE_PAWN_TABLE && board_pawn_key(board) != 0 && !EVAL_PRINTING) {
+        pawn_cache->probes++;
+        if (ppt->key == CACHE_KEY(board_pawn_key(board))) {
+            pawn_cache->hits++;
+            eval_values->pawn[WHITE] = ppt->pawn_eval[WHITE];
+            eval_values->pawn[BLACK] = ppt->pawn_eval[BLACK];
+            eval_values->bb_passers[WHITE] = passers_from_files(board, WHITE, ppt->passer_files[WHITE]);
+            eval_values->bb_passers[BLACK] = passers_from_files(board, BLACK, ppt->passer_files[BLACK]);
+            return;
+        }
     }
 
     // Evaluate each pawn.
@@ -54,8 +60,6 @@ void eval_pawns(BOARD *board, PAWN_TABLE *pawn_table, EVALUATION *eval_values)
 
             assert(piece_on_square(board, myc, pcsq) == PAWN);
 
-            eval_values->pawn[myc] += eval_pst_pawn(myc, pcsq);
-
             int doubled = (forward_path_bb(myc, pcsq) & pawn_bb(board, myc)) ? TRUE : FALSE;
             int connected = (connected_mask_bb(pcsq) & pawn_bb(board, myc)) ? TRUE : FALSE;
             int passed = (!doubled && !(passed_mask_bb(myc, pcsq) & pawn_bb(board, opp))) ? TRUE : FALSE;
@@ -89,12 +93,48 @@ void eval_pawns(BOARD *board, PAWN_TABLE *pawn_table, EVALUATION *eval_values)
 
     // Save information to pawn table.
     if (USE_PAWN_TABLE) {
-        ppt->key = board_pawn_key(board);
+        ppt->key = CACHE_KEY(board_pawn_key(board));
         ppt->pawn_eval[WHITE] = eval_values->pawn[WHITE];
         ppt->pawn_eval[BLACK] = eval_values->pawn[BLACK];
-        ppt->bb_passers[WHITE] = eval_values->bb_passers[WHITE];
-        ppt->bb_passers[BLACK] = eval_values->bb_passers[BLACK];
+        ppt->passer_files[WHITE] = passer_files(eval_values->bb_passers[WHITE]);
+        ppt->passer_files[BLACK] = passer_files(eval_values->bb_passers[BLACK]);
+        assert(passers_from_files(board, WHITE, ppt->passer_files[WHITE]) == eval_values->bb_passers[WHITE]);
+        assert(passers_from_files(board, BLACK, ppt->passer_files[BLACK]) == eval_values->bb_passers[BLACK]);
+    }
+}
+
+//------------------------------------------------------------------------------------
+//    Files with passed pawns, to be saved in the pawn table.
+//------------------------------------------------------------------------------------
+U8 passer_files(U64 passers)
+{
+    BBIX    pawns;
+    U8      files = 0;
+
+    pawns.u64 = passers;
+    while (pawns.u64) {
+        int pcsq = bb_first(pawns);
+        files |= (U8)(1 << get_file(pcsq));
+        bb_clear_bit(&pawns.u64, pcsq);
+    }
+    return files;
+}
+
+//------------------------------------------------------------------------------------
+//    Passed pawns from files saved in the pawn table: a passed pawn is the most advanced
+//    pawn of its color on the file.
+//------------------------------------------------------------------------------------
+U64 passers_from_files(BOARD *board, int myc, U8 files)
+{
+    U64     passers = 0;
+    BBIX    file_pawns;
+
+    for (int file = 0; files; file++, files >>= 1) {
+        if (!(files & 1)) continue;
+        file_pawns.u64 = pawn_bb(board, myc) & (BB_FILE_A >> file);
+        bb_set_bit(&passers, myc == WHITE ? bb_first(file_pawns) : bb_last(file_pawns));
     }
+    return passers;
 }
 
 //------------------------------------------------------------------------------------
@@ -107,9 +107,6 @@ void eval_knights(BOARD *board, EVALUATION *eval_values, int myc, int opp)
 
         assert(piece_on_square(board, myc, pcsq) == KNIGHT);
 
-        // pst
-        eval_values->pieces[myc] += eval_pst_knight(pcsq);
-        
         // mobility
         mobility.u64 = knight_moves_bb(pcsq) & eval_values->mobility_target[myc] & ~eval_values->pawn_attacks[opp];
         eval_values->mobility[myc] += B_KNIGHT_MOBILITY * bb_count(mobility);
@@ -166,9 +163,6 @@ void eval_bishops(BOARD *board, EVALUATION *eval_values, int myc, int opp)
 
         assert(piece_on_square(board, myc, pcsq) == BISHOP);
 
-        // pst
-        eval_values->pieces[myc] += eval_pst_bishop(pcsq);
-
         // mobility
         moves = bb_bishop_attacks(pcsq, occupied_bb(board));
         mobility.u64 = moves & eval_values->mobility_target[myc];
@@ -230,9 +224,6 @@ void eval_rooks(BOARD *board, EVALUATION *eval_values, int myc, int opp)
 
         assert(piece_on_square(board, myc, pcsq) == ROOK);
 
-        // pst
-        eval_values->pieces[myc] += eval_pst_rook(pcsq);
-
         // mobility
         moves = bb_rook_attacks(pcsq, occupied_bb(board));
         mobility.u64 = moves & eval_values->mobility_target[myc];
@@ -299,9 +290,6 @@ void eval_queens(BOARD *board, EVALUATION *eval_values, int myc, int opp)
 
         assert(piece_on_square(board, myc, pcsq) == QUEEN);
 
-        // pst
-        eval_values->pieces[myc] += eval_pst_queen(myc, pcsq);
-
         // moves
         U64 moves = 0;
         moves |= bb_rook_attacks(pcsq, occupied_bb(board));
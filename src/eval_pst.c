@@ -193,6 +193,58 @@ int eval_pst_king(int color, int pcsq)
     return MAKE_SCORE(pst_op, pst_eg);
 }
 
+//------------------------------------------------------------------------------------
+//  Build material and PST tables used by the board incremental scores. Must be called
+//  again when evaluation parameters change.
+//------------------------------------------------------------------------------------
+void eval_pst_init(void)
+{
+    MATERIAL_SCORE[PAWN] = SCORE_PAWN;
+    MATERIAL_SCORE[KNIGHT] = SCORE_KNIGHT;
+    MATERIAL_SCORE[BISHOP] = SCORE_BISHOP;
+    MATERIAL_SCORE[ROOK] = SCORE_ROOK;
+    MATERIAL_SCORE[QUEEN] = SCORE_QUEEN;
+    MATERIAL_SCORE[KING] = 0;
+
+    for (int color = WHITE; color <= BLACK; color++) {
+        for (int pcsq = 0; pcsq < 64; pcsq++) {
+            PST_SCORE[color][PAWN][pcsq] = eval_pst_pawn(color, pcsq);
+            PST_SCORE[color][KNIGHT][pcsq] = eval_pst_knight(pcsq);
+            PST_SCORE[color][BISHOP][pcsq] = eval_pst_bishop(pcsq);
+            PST_SCORE[color][ROOK][pcsq] = eval_pst_rook(pcsq);
+            PST_SCORE[color][QUEEN][pcsq] = eval_pst_queen(color, pcsq);
+            PST_SCORE[color][KING][pcsq] = eval_pst_king(color, pcsq);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+//  Calculate PST score from scratch (verification of incremental score).
+//------------------------------------------------------------------------------------
+int eval_pst_calc(BOARD *board, int color)
+{
+    int score = 0;
+
+    for (int pcsq = 0; pcsq < 64; pcsq++) {
+        int piece = piece_on_square(board, color, pcsq);
+        if (piece != NO_PIECE) score += PST_SCORE[color][piece][pcsq];
+    }
+    return score;
+}
+
+//------------------------------------------------------------------------------------
+//  Calculate material score from scratch (verification of incremental score).
+//------------------------------------------------------------------------------------
+int eval_material_calc(BOARD *board, int color)
+{
+    int score = 0;
+
+    for (int piece = PAWN; piece <= QUEEN; piece++) {
+        score += bb_count_u64(piece_bb(board, color, piece)) * MATERIAL_SCORE[piece];
+    }
+    return score;
+}
+
 //------------------------------------------------------------------------------------
 //  PST printing (tests)
 //------------------------------------------------------------------------------------
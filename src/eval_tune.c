@@ -47,6 +47,7 @@ int TUNE_PST_BISHOP  = TRUE;
 int TUNE_PST_ROOK    = TRUE;
 int TUNE_PST_QUEEN   = TRUE;
 int TUNE_PST_KING    = TRUE;
+int TUNE_LMR         = FALSE;   // search parameters, don't change the evaluation error
 
 enum    {SINGLE_VALUE, OPENING_ENDGAME} LINK_TYPE;
 
@@ -82,6 +83,22 @@ typedef struct {
 PARAM_LINK  tune_param_link[MAX_PARAM_SIZE];
 int         tune_param_link_count = 0;
 
+//  Search parameters, set by name. Kept apart from the tuner list, which is built only to tune.
+typedef struct s_search_param
+{
+    char    *name;
+    int     *value;
+}   SEARCH_PARAM;
+
+SEARCH_PARAM search_param[] = {
+    { "LMR_BASE",       &LMR_BASE },
+    { "LMR_DIVISOR",    &LMR_DIVISOR },
+    { "LMR_HISTORY",    &LMR_HISTORY },
+    { "LMR_IMPROVING",  &LMR_IMPROVING },
+    { "LMR_PV",         &LMR_PV },
+    { NULL,             NULL }
+};
+
 char    *tune_param_name[MAX_PARAM_SIZE];
 int     tune_param_value[MAX_PARAM_SIZE];
 int     tune_param_count = 0;
@@ -95,6 +112,7 @@ void    print_current_values(char *results_filename, int iteration, UINT time_sp
 double  calc_min_k(void);
 void    select_positions(char *input_pgn, char *output_pos);
 double  calc_e_main(double k, int tune_param[], int thread_count, TUNE_THREAD thread_list[]);
+void    init_search_param_list(void);
 void    calc_e_sub(TUNE_THREAD *thread_data);
 
 void eval_tune(void)
@@ -467,6 +485,44 @@ void init_param_list(void)
         create_link("PST", "PST_K_FILE2_EG", &PST_K_FILE2_EG, SINGLE_VALUE);
         create_link("PST", "PST_K_FILE3_EG", &PST_K_FILE3_EG, SINGLE_VALUE);
     }
+    if (TUNE_LMR) {
+        init_search_param_list();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Search parameters. Tuned by playing games (e.g. SPSA) with values set as UCI options.
+//-------------------------------------------------------------------------------------------------
+void init_search_param_list(void)
+{
+    for (int i = 0; search_param[i].name != NULL; i++) {
+        create_link("LMR", search_param[i].name, search_param[i].value, SINGLE_VALUE);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print search parameters as UCI spin options.
+//-------------------------------------------------------------------------------------------------
+void search_param_uci_options(void)
+{
+    for (int i = 0; search_param[i].name != NULL; i++) {
+        printf("option name %s type spin default %d min 0 max 1000\n", search_param[i].name, *search_param[i].value);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Set a search parameter by name and rebuild the reductions table. Returns FALSE if the
+//  parameter was not found.
+//-------------------------------------------------------------------------------------------------
+int search_param_set(char *name, int value)
+{
+    for (int i = 0; search_param[i].name != NULL; i++) {
+        if (strcmp(search_param[i].name, name)) continue;
+        *search_param[i].value = value;
+        lmr_init();
+        return TRUE;
+    }
+    return FALSE;
 }
 
 void send_param_to_engine(int values[]) 
@@ -477,6 +533,8 @@ void send_param_to_engine(int values[])
         else
             *tune_param_link[i].eval_param = MAKE_SCORE(values[tune_param_link[i].tune_index_op], values[tune_param_link[i].tune_index_eg]);
     }
+    eval_pst_init();
+    lmr_init();
 }
 
 double calc_e_main(double k, int tune_param[], int thread_count, TUNE_THREAD thread_list[])
@@ -493,6 +551,11 @@ double calc_e_main(double k, int tune_param[], int thread_count, TUNE_THREAD thr
         thread_list[i].settings.single_move_time = MAX_TIME;
         thread_list[i].settings.total_move_time = MAX_TIME;
         thread_list[i].settings.use_book = FALSE;
+        thread_list[i].settings.increment = 0;
+        thread_list[i].settings.max_nodes = 0;
+        thread_list[i].settings.mate_in = 0;
+        thread_list[i].settings.search_moves_count = 0;
+        new_game(&thread_list[i].game, FEN_NEW_GAME);
 
         THREAD_CREATE(thread_list[i].thread_id, calc_e_sub, &thread_list[i]);
     }
@@ -530,7 +593,7 @@ void calc_e_sub(TUNE_THREAD *thread_data)
         default: printf("wrong result character at line: %s\n", line); continue;
         }
 
-        new_game(&thread_data->game, &line[2]);
+        game_set_position(&thread_data->game, &line[2]);
         prepare_search(&thread_data->game, &thread_data->settings);
 
         thread_data->game.search.start_time = util_get_time();
@@ -601,7 +664,7 @@ void select_positions(char *input_pgn, char *output_pos)
     int         in_check;
     SETTINGS    settings;
 
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "select_positions.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -638,6 +701,10 @@ void select_positions(char *input_pgn, char *output_pos)
         settings.max_depth = MAX_DEPTH;
         settings.post_flag = POST_XBOARD;
         settings.use_book = FALSE;
+        settings.increment = 0;
+        settings.max_nodes = 0;
+        settings.mate_in = 0;
+        settings.search_moves_count = 0;
 
         prepare_search(game, &settings);
 
@@ -682,6 +749,8 @@ void select_positions(char *input_pgn, char *output_pos)
     pgn_close(&pgn_file);
 
     fclose(out_file);
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     printf("select_positions saved: [%s] -> [%s]  %d positions (%d loss on time)\n", input_pgn, output_pos, count, loss_on_time_count);
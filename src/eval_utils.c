@@ -23,14 +23,95 @@
 
 void eval_print_item(char *desc, int item[2]);
 void eval_print_value(double value);
+U64  eval_cache_entries(int size_kb, size_t entry_size);
+
+//  Cache sizes in KB for new allocations.
+int eval_cache_kb = DEFAULT_EVAL_CACHE;
+int pawn_cache_kb = DEFAULT_PAWN_CACHE;
 
 //------------------------------------------------------------------------------------
-//  Clear tables for a new game.
+//  Clear tables and counters for a new game.
 //------------------------------------------------------------------------------------
 void clear_eval_table(GAME *game)
 {
-    memset(game->eval_table, 0, sizeof(game->eval_table));
-    memset(game->pawn_table, 0, sizeof(game->pawn_table));
+    memset(game->eval_cache.table, 0, (size_t)(game->eval_cache.mask + 1) * sizeof(EVAL_TABLE));
+    memset(game->pawn_cache.table, 0, (size_t)(game->pawn_cache.mask + 1) * sizeof(PAWN_TABLE));
+    game->eval_cache.probes = game->eval_cache.hits = 0;
+    game->pawn_cache.probes = game->pawn_cache.hits = 0;
+}
+
+//------------------------------------------------------------------------------------
+//  Allocate eval and pawn caches with the current sizes and clear them. Caches already
+//  allocated with the same size are only cleared. The game data must start zeroed.
+//------------------------------------------------------------------------------------
+void eval_cache_alloc(GAME *game)
+{
+    U64 eval_entries = eval_cache_entries(eval_cache_kb, sizeof(EVAL_TABLE));
+    U64 pawn_entries = eval_cache_entries(pawn_cache_kb, sizeof(PAWN_TABLE));
+
+    if (game->eval_cache.table == NULL || game->eval_cache.mask != eval_entries - 1) {
+        free(game->eval_cache.table);
+        game->eval_cache.table = (EVAL_TABLE *)malloc((size_t)eval_entries * sizeof(EVAL_TABLE));
+        game->eval_cache.mask = eval_entries - 1;
+    }
+    if (game->pawn_cache.table == NULL || game->pawn_cache.mask != pawn_entries - 1) {
+        free(game->pawn_cache.table);
+        game->pawn_cache.table = (PAWN_TABLE *)malloc((size_t)pawn_entries * sizeof(PAWN_TABLE));
+        game->pawn_cache.mask = pawn_entries - 1;
+    }
+    if (game->eval_cache.table == NULL || game->pawn_cache.table == NULL) {
+        printf("no memory for evaluation cache!");
+        exit(-1);
+    }
+
+    clear_eval_table(game);
+}
+
+//------------------------------------------------------------------------------------
+//  Release eval and pawn caches.
+//------------------------------------------------------------------------------------
+void eval_cache_free(GAME *game)
+{
+    free(game->eval_cache.table);
+    free(game->pawn_cache.table);
+    game->eval_cache.table = NULL;
+    game->pawn_cache.table = NULL;
+}
+
+//------------------------------------------------------------------------------------
+//  Set cache sizes (KB) used by new allocations. Sizes are rounded down to a power of two
+//  number of entries. Returns the size accepted.
+//------------------------------------------------------------------------------------
+int eval_cache_set_size(int size_kb)
+{
+    eval_cache_kb = MAX(MIN_EVAL_CACHE, MIN(size_kb, MAX_EVAL_CACHE));
+    return eval_cache_kb;
+}
+
+int pawn_cache_set_size(int size_kb)
+{
+    pawn_cache_kb = MAX(MIN_EVAL_CACHE, MIN(size_kb, MAX_EVAL_CACHE));
+    return pawn_cache_kb;
+}
+
+//------------------------------------------------------------------------------------
+//  Number of entries for a cache size.
+//------------------------------------------------------------------------------------
+U64 eval_cache_entries(int size_kb, size_t entry_size)
+{
+    U64 entries = 1;
+    while (entries * 2 * entry_size <= (U64)size_kb * 1024) entries *= 2;
+    return entries;
+}
+
+//------------------------------------------------------------------------------------
+//  Print cache sizes and hit rates.
+//------------------------------------------------------------------------------------
+void eval_cache_stats_print(U64 eval_probes, U64 eval_hits, U64 pawn_probes, U64 pawn_hits)
+{
+    printf("Eval cache: %d KB  probes: %" PRIu64 "  hits: %3.2f%%  Pawn cache: %d KB  probes: %" PRIu64 "  hits: %3.2f%%\n",
+        eval_cache_kb, eval_probes, eval_probes ? 100.0 * (double)eval_hits / eval_probes : 0.0,
+        pawn_cache_kb, pawn_probes, pawn_probes ? 100.0 * (double)pawn_hits / pawn_probes : 0.0);
 }
 
 //------------------------------------------------------------------------------------
@@ -53,6 +134,7 @@ void eval_print_values(EVALUATION *eval_values)
     printf("Evaluation Term     Open    End      Open    End      Open    End\n");
     printf("---------------    -----  -----     -----  -----     -----  -----\n");
     eval_print_item("Material",     eval_values->material);
+    eval_print_item("PST",          eval_values->pst);
     eval_print_item("Pawn",         eval_values->pawn);
     eval_print_item("Pieces",       eval_values->pieces);
     eval_print_item("Mobility",     eval_values->mobility);
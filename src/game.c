@@ -22,20 +22,47 @@ You can find the GNU General Public License at http://www.gnu.org/licenses/
 //-------------------------------------------------------------------------------------------------
 
 //-------------------------------------------------------------------------------------------------
-//  Init game data
+//  Init game data. History tables of helper threads are reset too: they belong to the new game.
 //-------------------------------------------------------------------------------------------------
 void new_game(GAME *game, char *fen)
 {
     set_fen(&game->board, fen);
     memset(&game->search, 0, sizeof(SEARCH));
-    memset(&game->move_order, 0, sizeof(MOVE_ORDER));
+    move_order_alloc(&game->move_order);
+    clear_move_order(&game->move_order);
+    threads_clear_move_order();
     memset(&game->pv_line, 0, sizeof(PV_LINE));
-    memset(&game->eval_table, 0, sizeof(game->eval_table));
-    memset(&game->pawn_table, 0, sizeof(game->pawn_table));
-    tt_clear();
+    eval_cache_alloc(game);
+    tt_new_game();
     game->is_main_thread = TRUE;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Set a new position in a game already initialised by new_game, keeping its tables. Used by the
+//  tuner threads for each position: they run concurrently, so the hash table is not touched.
+//-------------------------------------------------------------------------------------------------
+void game_set_position(GAME *game, char *fen)
+{
+    set_fen(&game->board, fen);
+    memset(&game->search, 0, sizeof(SEARCH));
+    init_move_order(&game->move_order);
+    clear_killers(&game->move_order);
+    memset(&game->pv_line, 0, sizeof(PV_LINE));
+    game->is_main_thread = TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Target game uses the eval caches and continuation history of source game. Only one of them
+//  can be searching.
+//-------------------------------------------------------------------------------------------------
+void game_share_caches(GAME *target, GAME *source)
+{
+    target->eval_cache = source->eval_cache;
+    target->pawn_cache = source->pawn_cache;
+    target->move_order.own_cont_history = source->move_order.own_cont_history;
+    init_move_order(&target->move_order);
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Returns game result for current position.
 //-------------------------------------------------------------------------------------------------
@@ -61,6 +61,7 @@ typedef unsigned __int64 uint64_t;
 #include <ctype.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <assert.h>
 #include <math.h>
 #include <inttypes.h>
@@ -76,6 +77,17 @@ typedef void*(*pt_start_fn)(void*);
 #define THREAD_CREATE(x,f,t)    pthread_create(&(x),NULL,(pt_start_fn)f,t)
 #define THREAD_WAIT(x)          pthread_join(x, NULL)
 
+typedef pthread_mutex_t MUTEX;
+typedef pthread_cond_t  COND;
+
+#define MUTEX_INIT(m)           pthread_mutex_init(&(m), NULL)
+#define MUTEX_LOCK(m)           pthread_mutex_lock(&(m))
+#define MUTEX_UNLOCK(m)         pthread_mutex_unlock(&(m))
+#define COND_INIT(c)            pthread_cond_init(&(c), NULL)
+#define COND_WAIT(c,m)          pthread_cond_wait(&(c), &(m))
+#define COND_SIGNAL(c)          pthread_cond_signal(&(c))
+#define COND_BROADCAST(c)       pthread_cond_broadcast(&(c))
+
 #else // Windows and MinGW
 
 #define WIN32_LEAN_AND_MEAN
@@ -87,6 +99,32 @@ typedef HANDLE THREAD_ID;
 #define THREAD_CREATE(x,f,t)    (x = CreateThread(NULL,0,(LPTHREAD_START_ROUTINE)f,t,0,NULL))
 #define THREAD_WAIT(x)          { WaitForSingleObject(x, INFINITE); CloseHandle(x); }
 
+typedef CRITICAL_SECTION MUTEX;
+typedef CONDITION_VARIABLE COND;
+
+#define MUTEX_INIT(m)           InitializeCriticalSection(&(m))
+#define MUTEX_LOCK(m)           EnterCriticalSection(&(m))
+#define MUTEX_UNLOCK(m)         LeaveCriticalSection(&(m))
+#define COND_INIT(c)            InitializeConditionVariable(&(c))
+#define COND_WAIT(c,m)          SleepConditionVariableCS(&(c), &(m), INFINITE)
+#define COND_SIGNAL(c)          WakeConditionVariable(&(c))
+#define COND_BROADCAST(c)       WakeAllConditionVariable(&(c))
+
+#endif
+
+// Atomic operations with relaxed memory order, used for data shared by search threads.
+#if defined(_MSC_VER)
+#define ATOMIC_ADD(p,v)         _InterlockedExchangeAdd((volatile long *)(p), (long)(v))
+#define ATOMIC_ADD64(p,v)       _InterlockedExchangeAdd64((volatile __int64 *)(p), (__int64)(v))
+#define ATOMIC_LOAD(p)          (*(volatile long *)(p))
+#define ATOMIC_STORE(p,v)       (*(volatile long *)(p) = (long)(v))
+#define CACHE_ALIGN             __declspec(align(64))
+#else
+#define ATOMIC_ADD(p,v)         __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_ADD64(p,v)       __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD(p)          __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_STORE(p,v)       __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define CACHE_ALIGN             __attribute__((aligned(64)))
 #endif
 
 // Variables are defined only once in this file.
@@ -94,6 +132,13 @@ typedef HANDLE THREAD_ID;
 #define EXTERN extern
 #endif
 
+// Small hot accessors are defined in this file, so they are inlined without link time optimization.
+#if defined(_MSC_VER)
+#define INLINE static __inline
+#else
+#define INLINE static inline
+#endif
+
 // Type definitions.
 typedef uint64_t        U64; // this is the bitboard
 typedef int32_t         S32;
@@ -160,13 +205,30 @@ enum    {RANK8, RANK7, RANK6, RANK5, RANK4, RANK3, RANK2, RANK1};
 #define RANKS       8
 #define FILES       8
 
-U64  square_bb(int index);
 void bb_set_bit(U64 *bb, int index);
 void bb_set_bit_rf(U64 *bb, int rank, int file);
 void bb_clear_bit(U64 *bb, int index);
-int  bb_is_one(U64 bb, int index);
 U64  square_color_bb(int index);
 
+//-------------------------------------------------------------------------------------------------
+//  Return a bitboard for square index
+//  Square A8 = 0 and square H1 = 63.
+//-------------------------------------------------------------------------------------------------
+INLINE U64 square_bb(int index)
+{
+    assert(index >= 0 && index < 64);
+    return (U64)1 << (63 - index);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Return TRUE if bit is 1
+//-------------------------------------------------------------------------------------------------
+INLINE int bb_is_one(U64 bb, int index)
+{
+    assert(index >= 0 && index < 64);
+    return bb & square_bb(index) ? TRUE : FALSE;
+}
+
 // This union is used to get first and last index, and bit counts.
 typedef union u_bitboard_index
 {
@@ -176,6 +238,7 @@ typedef union u_bitboard_index
 }   BBIX;
 
 void    bb_init(void);
+char    *bb_backend_name(void);
 int     bb_first(BBIX bbix);
 int     bb_last(BBIX bbix);
 int     bb_count(BBIX bbix);
@@ -205,6 +268,7 @@ U64     connected_mask_bb(int from_square);
 U64     isolated_mask_bb(int from_square);
 
 void    magic_init(void);
+char    *magic_backend_name(void);
 U64     bb_rook_attacks(int sq, U64 occup);
 U64     bb_bishop_attacks(int sq, U64 occup);
 void    bb_print(char *msg, U64 bb);
@@ -225,6 +289,8 @@ void    bb_print(char *msg, U64 bb);
 
 typedef U32         MOVE;
 
+#define QUIET_BIT   0x80000000
+
 #define MOVE_NONE   ((MOVE)0)
 
 MOVE    pack_quiet(int moving_piece, int from_square, int to_square);
@@ -236,19 +302,112 @@ MOVE    pack_promotion(int from_square, int to_square, int prom_piece);
 MOVE    pack_capture_promotion(int captured_piece, int from_square, int to_square, int prom_piece);
 MOVE    pack_null_move(void);
 
-int     unpack_from(MOVE move);
-int     unpack_to(MOVE move);
-int     unpack_type(MOVE move);
-int     unpack_piece(MOVE move);
-int     unpack_capture(MOVE move);
-int     unpack_prom_piece(MOVE move);
-int     unpack_ep_square(MOVE move);
-int     unpack_ep_pawn_square(MOVE move);
-int     move_is_quiet(MOVE move);
-int     move_is_castle(MOVE move);
-int     move_is_promotion(MOVE move);
-int     move_is_en_passant(MOVE move);
-int     move_is_capture(MOVE move);
+//-------------------------------------------------------------------------------------------------
+//    Return the move "from square"
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_from(MOVE move)
+{
+    return (move >> 6) & 0x3F;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return the move "to square"
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_to(MOVE move)
+{
+    return move & 0x3F;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return the move type
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_type(MOVE move)
+{
+    return (move >> 12) & 0x0F;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return the moving piece
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_piece(MOVE move)
+{
+    return (move >> 16) & 0x07;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return capture piece
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_capture(MOVE move)
+{
+    return (move >> 19) & 0x07;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return promotion piece
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_prom_piece(MOVE move)
+{
+    return (move >> 22) & 0x07;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return en passant square
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_ep_square(MOVE move)
+{
+    return (move >> 25) & 0x3F;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Return en passant pawn square
+//-------------------------------------------------------------------------------------------------
+INLINE int unpack_ep_pawn_square(MOVE move)
+{
+    return (move >> 25) & 0x3F;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Indicates if it is quiet move.
+//-------------------------------------------------------------------------------------------------
+INLINE int move_is_quiet(MOVE move)
+{
+    return move & QUIET_BIT;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Indicates if it is castle move.
+//-------------------------------------------------------------------------------------------------
+INLINE int move_is_castle(MOVE move)
+{
+    int type = unpack_type(move);
+    return type == MT_CSWKS || type == MT_CSWQS || type == MT_CSBKS || type == MT_CSBQS;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Indicates a promotion move (pawn move or pawn capture)
+//-------------------------------------------------------------------------------------------------
+INLINE int move_is_promotion(MOVE move)
+{
+    int type = unpack_type(move);
+    return type == MT_PROMO || type == MT_CPPRM;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Indicates en passant capture move
+//-------------------------------------------------------------------------------------------------
+INLINE int move_is_en_passant(MOVE move)
+{
+    return unpack_type(move) == MT_EPCAP;
+}
+
+//-------------------------------------------------------------------------------------------------
+//    Indicates capture moves
+//-------------------------------------------------------------------------------------------------
+INLINE int move_is_capture(MOVE move)
+{
+    int type = unpack_type(move);
+    return type == MT_CAPPC || type == MT_CPPRM || type == MT_EPCAP;
+}
 
 // General use macros.
 #define ABS(a)       ((a) < 0 ? -(a) : (a))
@@ -256,8 +415,6 @@ int     move_is_capture(MOVE move);
 #define MIN(a, b)    ((a) < (b) ? (a) : (b))
 
 void    bb_data_init(void);
-int     get_rank(int square);
-int     get_file(int square);
 int     get_square(int rank, int file);
 int     get_front_square(int color, int pcsq);
 int     get_relative_rank(int color, int rank);
@@ -265,6 +422,24 @@ int     get_relative_square(int color, int pcsq);
 int     is_rank_valid(int rank);
 int     is_file_valid(int file);
 
+//-------------------------------------------------------------------------------------------------
+//  Return rank (0-7) from a square (0-63)
+//-------------------------------------------------------------------------------------------------
+INLINE int get_rank(int square)
+{
+    assert(square >= 0 && square <= 63);
+    return square >> 3;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Return file (0-7) from a square (0-63)
+//-------------------------------------------------------------------------------------------------
+INLINE int get_file(int square)
+{
+    assert(square >= 0 && square <= 63);
+    return square & 0x07;
+}
+
 #define SQ_NE(sq)   ((sq) - 7)
 #define SQ_NW(sq)   ((sq) - 9)
 #define SQ_SE(sq)   ((sq) + 9)
@@ -280,6 +455,24 @@ typedef struct s_pv_line {
     int     pv_size[MAX_PLY];
 }   PV_LINE;
 
+// Root moves: legal moves at root with search data, ordered between iterations.
+#define MAX_ROOT_MOVES  256
+#define MAX_MULTIPV     32
+
+typedef struct s_root_move {
+    MOVE    move;
+    int     score;                  // score in current iteration, -MAX_SCORE if not best
+    int     prev_score;             // score in previous iteration
+    U64     nodes;                  // nodes searched in current iteration
+    int     pv_size;
+    MOVE    pv[MAX_PLY];            // principal variation starting with this move
+}   ROOT_MOVE;
+
+typedef struct s_root_moves {
+    ROOT_MOVE   moves[MAX_ROOT_MOVES];
+    int         count;
+}   ROOT_MOVES;
+
 
 // Eval score definitions.
 // Instead of using two variables for opening and endgame values, 
@@ -328,6 +521,7 @@ enum e_squares
 #define BB_DARK_SQ  ((U64)0x55AA55AA55AA55AA)
 #define BB_FILES_QS ((U64)0xF0F0F0F0F0F0F0F0)
 #define BB_FILES_KS ((U64)0x0F0F0F0F0F0F0F0F)
+#define BB_FILE_A   ((U64)0x8080808080808080)
 
 //  Search data: move, nodes, time control, etc.
 //  Times are in milliseconds.
@@ -349,28 +543,61 @@ typedef struct s_search
     MOVE    ponder_move;            // pondering move
     int     cur_depth;              // current depth
     int     score_drop;             // controls when score drops
-    int     abort;                  // indicates end of search
+    volatile int abort;             // indicates end of search, set by other threads
     int     root_move_count;        // number of moves at root node, used by xboard analysis
     int     root_move_search;       // number of move searched at root node, used by xboard analysis
+    int     completed_depth;        // last iteration completed
+    int     multipv;                // number of principal variations to search
+    int     pv_index;               // current principal variation line in multipv search
+    U64     tt_probes;              // transposition table probes
+    U64     tt_hits;                // transposition table cutoffs or move hints
+    U64     max_nodes;              // node limit, 0 = no limit
+    int     mate_in;                // stop when a mate in this number of moves is found, 0 = no limit
+    int     search_moves_count;     // number of root moves to search, 0 = all moves
+    MOVE    search_moves[MAX_ROOT_MOVES];
+    int     static_eval[MAX_PLY];   // static evaluation by ply, -MAX_SCORE when in check
 }   SEARCH;
 
-//  Pawn evaluation table: cache for already evaluated pawn structure
+//  Pawn evaluation table: cache for already evaluated pawn structure. The entry index comes
+//  from the low bits of the pawn key and the high 32 bits are kept to verify the entry.
+//  Passed pawns are saved as files: there is at most one passer per file and color.
 typedef struct s_pawn_table
 {
-    U64     bb_passers[COLORS];
-    U64     key;
+    U32     key;
     S32     pawn_eval[COLORS];
+    U8      passer_files[COLORS];
 }   PAWN_TABLE;
 
 //  Evaluation table: cache for already evaluated positions
 typedef struct s_eval_table
 {
-    U64     key;
+    U32     key;
     S32     score;
 }   EVAL_TABLE;
 
-#define PAWN_TABLE_SIZE 16384
-#define EVAL_TABLE_SIZE 32768
+//  Per thread caches, sized by the EvalCache and PawnCache options (KB).
+typedef struct s_eval_cache
+{
+    EVAL_TABLE  *table;
+    U64         mask;       // entries - 1
+    U64         probes;
+    U64         hits;
+}   EVAL_CACHE;
+
+typedef struct s_pawn_cache
+{
+    PAWN_TABLE  *table;
+    U64         mask;       // entries - 1
+    U64         probes;
+    U64         hits;
+}   PAWN_CACHE;
+
+#define DEFAULT_EVAL_CACHE  256
+#define DEFAULT_PAWN_CACHE  256
+#define MIN_EVAL_CACHE      16
+#define MAX_EVAL_CACHE      65536
+
+#define CACHE_KEY(key)      ((U32)((key) >> 32))
 
 EXTERN int EVAL_PRINTING;
 
@@ -379,6 +606,7 @@ typedef struct s_eval_values
     int     phase;
     int     draw_adjust;
     int     material[COLORS];
+    int     pst[COLORS];
     int     pawn[COLORS];
     int     king[COLORS];
     int     passed[COLORS];
@@ -404,6 +632,8 @@ typedef struct s_move_history
 {
     U64     board_key;
     U64     pawn_key;
+    S32     material[COLORS];
+    S32     pst[COLORS];
     MOVE    move;
     U8      fifty_move_rule;
     U8      ep_square;
@@ -411,12 +641,36 @@ typedef struct s_move_history
     U8      can_castle_qs;
 }   MOVE_HIST;
 
-//  Move ordering data: history heuristic and killers. 
-typedef struct s_move_ordering {
+//  History heuristic and counter moves. Can be shared by all search threads.
+//  Capture history counts captures by [color][piece][to square][captured piece].
+typedef struct s_history_table {
     int     search_count[COLORS][NUM_PIECES][64];
     int     beta_cutoff_count[COLORS][NUM_PIECES][64];
-    MOVE    killers[MAX_PLY][COLORS][2];
     MOVE    counter_move[COLORS][NUM_PIECES][64][2];
+    int     capture_search_count[COLORS][NUM_PIECES][64][NUM_PIECES];
+    int     capture_cutoff_count[COLORS][NUM_PIECES][64][NUM_PIECES];
+}   HISTORY_TABLE;
+
+//  Continuation history counts quiet moves after the moves made 1 and 2 plies before:
+//  [plies - 1][color][previous piece][previous to square][piece][to square].
+//  Allocated on the heap (about 4.7 MB) and aged between searches instead of cleared.
+#define CONT_PLIES  2
+
+typedef struct s_cont_history {
+    int     search_count[CONT_PLIES][COLORS][NUM_PIECES][64][NUM_PIECES][64];
+    int     cutoff_count[CONT_PLIES][COLORS][NUM_PIECES][64][NUM_PIECES][64];
+}   CONT_HISTORY;
+
+//  Move ordering data: history heuristic and killers. 
+typedef struct s_move_ordering {
+    HISTORY_TABLE   *history;       // points to own_history or to the shared history table
+    CONT_HISTORY    *cont_history;  // points to own_cont_history or to the shared table
+    int             shared;         // history is shared: use atomic updates
+    HISTORY_TABLE   own_history;
+    CONT_HISTORY    *own_cont_history;
+    MOVE            killers[MAX_PLY][COLORS][2];
+    U64             sort_lists;     // move lists sorted, counted when select stats are enabled
+    U64             sort_comparisons;
 }   MOVE_ORDER;
 
 //  Board representation (bitboard based)
@@ -434,25 +688,41 @@ typedef struct s_board
     }           state[COLORS];
     U64         key;
     U64         pawn_key;
+    S32         material[COLORS];   // incremental material score (packed opening/endgame)
+    S32         pst[COLORS];        // incremental piece square tables score (packed opening/endgame)
     U16         ply;
     U16         histply;
     U8          side_on_move;
     U8          fifty_move_rule;
     U8          ep_square;
-    MOVE_HIST   history[MAX_HIST];
+    MOVE_HIST   history[MAX_HIST];  // last field: see copy_board
 }   BOARD;
 
+//  NNUE accumulator: first layer output for each side's point of view.
+#define NNUE_HALF_DIMS  256
+
+typedef struct s_nnue_accumulator {
+    S16     values[COLORS][NNUE_HALF_DIMS];
+    U64     key;            // board key of the position calculated
+    int     net_id;         // network loaded when calculated
+}   NNUE_ACCUMULATOR;
+
 //  Game Data
 typedef struct s_game {
     SEARCH      search;
     BOARD       board;
     PV_LINE     pv_line;
+    ROOT_MOVES  root_moves;
     MOVE_ORDER  move_order;
-    PAWN_TABLE  pawn_table[PAWN_TABLE_SIZE];
-    EVAL_TABLE  eval_table[EVAL_TABLE_SIZE];
+    PAWN_CACHE  pawn_cache;
+    EVAL_CACHE  eval_cache;
+    NNUE_ACCUMULATOR nnue_stack[MAX_PLY + 1];   // by search ply
     int         is_main_thread;
-    THREAD_ID   *thread_handle;
+    THREAD_ID   thread_handle;
     int         thread_number;
+    int         search_id;      // last search started by helper thread
+    U64         wake_latency;   // nanoseconds from search start signal to helper start
+    U64         search_time;    // nanoseconds running the last search
 }   GAME;
 
 // Move generation and selection
@@ -471,7 +741,7 @@ typedef struct s_move_list
     MOVE        late_moves[MAX_MOVE];
     int         late_moves_count;
     int         late_moves_next;
-    int         sort;
+    int         sort_limit;
     U64         pins;
     BOARD       *board;
     MOVE_ORDER  *move_order;
@@ -494,6 +764,11 @@ typedef struct s_settings {
     int     max_depth;              // set by sd command.
     int     post_flag;              // post format.
     int     use_book;               // opening book use.
+    UINT    increment;              // time increment per move: winc/binc in UCI, level in XBoard.
+    U64     max_nodes;              // set by go nodes in UCI mode. 0 = no limit.
+    int     mate_in;                // set by go mate in UCI mode. 0 = no mate search.
+    int     search_moves_count;     // set by go searchmoves in UCI mode. 0 = all moves.
+    MOVE    search_moves[MAX_ROOT_MOVES];
 }   SETTINGS;
 
 // Zobrish Keys (hash)
@@ -514,6 +789,8 @@ void    print_game_result(GAME *game);
 void    trans_table_test(char *fen, char *desc);
 void    auto_play(int total_games, SETTINGS *settings);
 void    new_game(GAME *game, char *fen);
+void    game_set_position(GAME *game, char *fen);
+void    game_share_caches(GAME *target, GAME *source);
 int     valid_threads(int threads);
 int     valid_hash_size(int hash_size);
 
@@ -528,16 +805,28 @@ MOVE    book_next_move(GAME *game);
 int     is_illegal(BOARD *board, MOVE move);
 int     is_incheck(BOARD *board, int color);
 int     is_pseudo_legal(BOARD *board, U64 pins, MOVE move);
+int     is_legal(BOARD *board, U64 pins, int incheck, MOVE move);
 U64     find_pins(BOARD *board);
+U64     pin_mask_bb(int king_square, int from_square);
+int     is_en_passant_legal(BOARD *board, MOVE move);
 int     is_square_attacked(BOARD *board, int square, int by_color, U64 occup);
+int     is_white_kingside_attacked(BOARD *board);
+int     is_white_queenside_attacked(BOARD *board);
+int     is_black_kingside_attacked(BOARD *board);
+int     is_black_queenside_attacked(BOARD *board);
 
 void    gen_moves(BOARD *board, MOVE_LIST *ml);
 void    gen_caps(BOARD *board, MOVE_LIST *ml);
 void    gen_check_evasions(BOARD *board, MOVE_LIST *ml);
+U64     pawn_push_bb(BOARD *board, MOVE_LIST *ml, int color);
 void    print_current_moves(GAME *game);
 void    print_moves(BOARD *board, MOVE_LIST *ml);
 
 void    select_init(MOVE_LIST *ml, GAME *game, int incheck, MOVE ttm, int caps);
+void    select_sort_depth(MOVE_LIST *ml, int depth);
+void    select_stats_reset(int enable);
+void    select_stats_print(U64 nodes);
+void    select_stats_collect(MOVE_ORDER *mo);
 void    add_move(MOVE_LIST *ml, MOVE move);
 void    add_all_promotions(MOVE_LIST *ml, int from_square, int to_square);
 void    add_all_capture_promotions(MOVE_LIST *ml, int from_square, int to_square, int captured_piece);
@@ -549,10 +838,20 @@ int     is_mate_score(int score);
 int     is_eval_score(int score);
 
 //  Move ordering
+void    move_order_alloc(MOVE_ORDER *move_order);
+void    move_order_free(MOVE_ORDER *move_order);
+void    init_move_order(MOVE_ORDER *move_order);
+void    clear_killers(MOVE_ORDER *move_order);
+void    clear_move_order(MOVE_ORDER *move_order);
+void    clear_shared_history(void);
+void    set_shared_history(int shared);
+int     get_shared_history(void);
 void    save_beta_cutoff_data(MOVE_ORDER *move_order, int color, int ply, MOVE best_move, MOVE_LIST *ml, MOVE previous_move);
-int     get_beta_cutoff_percent(MOVE_ORDER *move_order, int color, MOVE move);
-int     get_pruning_margin(MOVE_ORDER *move_order, int color, MOVE move);
-int     get_has_bad_history(MOVE_ORDER *move_order, int color, MOVE move);
+void    save_capture_data(MOVE_ORDER *move_order, int color, MOVE move, int cutoff);
+int     get_beta_cutoff_percent(MOVE_ORDER *move_order, BOARD *board, MOVE move);
+int     get_pruning_margin(MOVE_ORDER *move_order, BOARD *board, MOVE move);
+int     get_has_bad_history(MOVE_ORDER *move_order, BOARD *board, MOVE move);
+int     get_capture_cutoff_percent(MOVE_ORDER *move_order, int color, MOVE move);
 int     is_killer(MOVE_ORDER *move_order, int color, int ply, MOVE move);
 int     is_counter_move(MOVE_ORDER *move_order, int prev_color, MOVE previous_move, MOVE current_move);
 
@@ -560,12 +859,23 @@ int     is_counter_move(MOVE_ORDER *move_order, int prev_color, MOVE previous_mo
 // Search
 void    prepare_search(GAME *game, SETTINGS *settings);
 void    threads_init(int threads_count);
+void    threads_eval_cache_alloc(void);
+void    threads_clear_eval_table(void);
+void    threads_clear_move_order(void);
 void    search_run(GAME *game, SETTINGS *settings);
 U64     get_additional_threads_nodes(void);
 U64     get_additional_threads_tbhits(void);
+void    threads_stats_reset(void);
+void    threads_stats_print(void);
+void    smp_stats_reset(void);
+void    smp_stats_print(char *prefix, int last_search, double baseline_nps);
 void    ponder_search(GAME *game);
 void    update_pv(PV_LINE *pv_line, int ply, MOVE move);
 int     null_depth(int depth);
+void    lmr_param_init(void);
+void    lmr_init(void);
+int     lmr_reduction(int depth, int move_count);
+int     is_improving(GAME *game, int ply);
 int     piece_value(int piece);
 int     is_free_pawn(BOARD *board, int color, MOVE move);
 int     has_pawn_on_rank7(BOARD *board, int color);
@@ -575,6 +885,12 @@ int     search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth);
 int     search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE exclude_move, int prev_move_count);
 int     quiesce(GAME *game, UINT incheck, int alpha, int beta, int depth);
 void    post_info(GAME *game, int score, int depth);
+void    post_line(GAME *game, int score, int depth, MOVE *pv, int pv_size, int multipv);
+void    set_multipv(int lines);
+void    root_moves_init(GAME *game);
+void    root_moves_sort(GAME *game, int first, int last);
+void    root_moves_new_iteration(GAME *game);
+MOVE    next_root_move(GAME *game, int *index);
 int     is_check(BOARD *board, MOVE move);
 
 // see
@@ -587,10 +903,18 @@ int     get_game_result(GAME *game);
 void    tt_age(void);
 void    tt_init(size_t size_mb);
 void    tt_clear(void);
+void    tt_clear_start(void);
+int     tt_clear_wait(void);
+void    tt_new_game(void);
+void    tt_set_threads(int threads);
+void    tt_print_info(char *prefix);
+void    tt_set_clear_new_game(int clear);
 void    tt_save(BOARD *board, int depth, int search_score, S8 flag, MOVE best);
 int     tt_probe(BOARD *board, int depth, int alpha, int beta, int *search_score, MOVE *best_move);
 MOVE    tt_move(BOARD *board);
 int     tt_score(BOARD *board, int min_depth, int *tt_score);
+void    tt_stats_reset(int enable);
+void    tt_stats_print(void);
 
 // Analyze Mode
 void    analyze_mode(GAME *game);
@@ -598,6 +922,7 @@ void    analyze_mode(GAME *game);
 // Board
 void    new_game(GAME *game, char *fen);
 void    set_fen(BOARD *board, char *fen);
+void    copy_board(BOARD *target, BOARD *source);
 void    make_move(BOARD *board, MOVE move);
 void    undo_move(BOARD *board);
 int     is_draw(BOARD *board);
@@ -609,43 +934,11 @@ int     pieces_count(BOARD *board, int color);
 int     is_valid(BOARD *board, MOVE move);
 int     square_distance(int square1, int square2);
 void    board_print(BOARD *board, char *text);
-U64     king_bb(BOARD *board, int color);
-U64     queen_bb(BOARD *board, int color);
-U64     rook_bb(BOARD *board, int color);
-U64     bishop_bb(BOARD *board, int color);
-U64     knight_bb(BOARD *board, int color);
-U64     pawn_bb(BOARD *board, int color);
-U64     queen_rook_bb(BOARD *board, int color);
-U64     queen_bishop_bb(BOARD *board, int color);
-int     king_count(BOARD *board, int color);
-int     queen_count(BOARD *board, int color);
-int     rook_count(BOARD *board, int color);
-int     bishop_count(BOARD *board, int color);
-int     knight_count(BOARD *board, int color);
-int     pawn_count(BOARD *board, int color);
-U64     occupied_bb(BOARD *board);
-U64     empty_bb(BOARD *board);
-int     king_square(BOARD *board, int color);
-U8      side_on_move(BOARD *board);
-MOVE    get_last_move_made(BOARD *board);
-U64     board_key(BOARD *board);
-U64     board_pawn_key(BOARD *board);
-int     piece_on_square(BOARD *board, int color, int square);
-U64     all_pieces_bb(BOARD *board, int color);
-U64     qrnb_bb(BOARD *board, int color);
-U64     piece_bb(BOARD *board, int color, int piece);
-int     has_pieces(BOARD *board, int color);
-U64     ep_square_bb(BOARD *board);
-int     ep_square(BOARD *board);
-int     can_castle_ks_flag(BOARD *board, int color);
-int     can_castle_qs_flag(BOARD *board, int color);
+
 int     can_generate_castle_ks(BOARD *board, int color);
 int     can_generate_castle_qs(BOARD *board, int color);
-void    set_ply(BOARD *board, U16 value);
-U16     get_ply(BOARD *board);
 int     get_played_moves(BOARD *board, char *line, size_t max_chars);
 int     get_history_moves(BOARD *board, MOVE move[], int max_moves);
-U16     get_history_ply(BOARD *board);
 int     get_played_moves_count(BOARD *board, int color);
 void    move_piece(BOARD *board, int color, int type, int frsq, int tosq);
 void    set_piece(BOARD *board, int color, int type, int tosq);
@@ -654,8 +947,295 @@ void    move_piece_undo(BOARD *board, int color, int type, int frsq, int tosq);
 void    set_piece_undo(BOARD *board, int color, int type, int index);
 void    remove_piece_undo(BOARD *board, int color, int type, int index);
 
+//-------------------------------------------------------------------------------------------------
+//  King BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 king_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[KING].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Queen BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 queen_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[QUEEN].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Rook BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 rook_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[ROOK].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Bishop BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 bishop_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[BISHOP].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Knight BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 knight_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[KNIGHT].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Pawn BB
+//-------------------------------------------------------------------------------------------------
+INLINE U64 pawn_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[PAWN].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Queen and Rook pieces
+//-------------------------------------------------------------------------------------------------
+INLINE U64 queen_rook_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[QUEEN].u64 | board->state[color].piece[ROOK].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Queen and Bishop pieces
+//-------------------------------------------------------------------------------------------------
+INLINE U64 queen_bishop_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[QUEEN].u64 | board->state[color].piece[BISHOP].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  King count
+//-------------------------------------------------------------------------------------------------
+INLINE int king_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[KING];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Queen count
+//-------------------------------------------------------------------------------------------------
+INLINE int queen_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[QUEEN];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Rook count
+//-------------------------------------------------------------------------------------------------
+INLINE int rook_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[ROOK];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Bishop count
+//-------------------------------------------------------------------------------------------------
+INLINE int bishop_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[BISHOP];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Knight count
+//-------------------------------------------------------------------------------------------------
+INLINE int knight_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[KNIGHT];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Knight count
+//-------------------------------------------------------------------------------------------------
+INLINE int pawn_count(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].count[PAWN];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Occupied squares
+//-------------------------------------------------------------------------------------------------
+INLINE U64 occupied_bb(BOARD *board)
+{
+    return board->state[WHITE].all_pieces | board->state[BLACK].all_pieces;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Empty squares
+//-------------------------------------------------------------------------------------------------
+INLINE U64 empty_bb(BOARD *board)
+{
+    return ~(board->state[WHITE].all_pieces | board->state[BLACK].all_pieces);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  King square
+//-------------------------------------------------------------------------------------------------
+INLINE int king_square(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].king_square;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Side on move
+//-------------------------------------------------------------------------------------------------
+INLINE U8 side_on_move(BOARD *board)
+{
+    return board->side_on_move;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Get last move made on the board
+//-------------------------------------------------------------------------------------------------
+INLINE MOVE get_last_move_made(BOARD *board)
+{
+    if (board->histply == 0) return MOVE_NONE;
+    return board->history[board->histply - 1].move;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Board key
+//-------------------------------------------------------------------------------------------------
+INLINE U64 board_key(BOARD *board)
+{
+    return board->key;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Board pawn key
+//-------------------------------------------------------------------------------------------------
+INLINE U64 board_pawn_key(BOARD *board)
+{
+    return board->pawn_key;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Piece on square
+//-------------------------------------------------------------------------------------------------
+INLINE int piece_on_square(BOARD *board, int color, int square)
+{
+    assert(color == WHITE || color == BLACK);
+    assert(square >= 0 && square < 64);
+    return board->state[color].square[square];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  All Pieces
+//-------------------------------------------------------------------------------------------------
+INLINE U64 all_pieces_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].all_pieces;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  QRNB Pieces
+//-------------------------------------------------------------------------------------------------
+INLINE U64 qrnb_bb(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[QUEEN].u64 | board->state[color].piece[ROOK].u64
+        | board->state[color].piece[KNIGHT].u64 | board->state[color].piece[BISHOP].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Piece bitboard
+//-------------------------------------------------------------------------------------------------
+INLINE U64 piece_bb(BOARD *board, int color, int piece)
+{
+    assert(color == WHITE || color == BLACK);
+    assert(piece >= PAWN && piece <= KING);
+    return board->state[color].piece[piece].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Has pieces (rook, queen, bishop, knight)
+//-------------------------------------------------------------------------------------------------
+INLINE int has_pieces(BOARD *board, int color)
+{
+    assert(color == WHITE || color == BLACK);
+    return board->state[color].piece[QUEEN].u64 || board->state[color].piece[ROOK].u64
+        || board->state[color].piece[BISHOP].u64 || board->state[color].piece[KNIGHT].u64;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Ep square bitboard
+//-------------------------------------------------------------------------------------------------
+INLINE U64 ep_square_bb(BOARD *board)
+{
+    return board->ep_square != 0 ? square_bb(board->ep_square) : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Ep square
+//-------------------------------------------------------------------------------------------------
+INLINE int ep_square(BOARD *board)
+{
+    return board->ep_square;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Return flag for king side castle move
+//-------------------------------------------------------------------------------------------------
+INLINE int can_castle_ks_flag(BOARD *board, int color)
+{
+    return board->state[color].can_castle_ks;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Return flag for queen side castle move
+//-------------------------------------------------------------------------------------------------
+INLINE int can_castle_qs_flag(BOARD *board, int color)
+{
+    return board->state[color].can_castle_qs;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  board data
+//-------------------------------------------------------------------------------------------------
+INLINE void set_ply(BOARD *board, U16 value)
+{
+    board->ply = value;
+}
+
+INLINE U16 get_ply(BOARD *board)
+{
+    return board->ply;
+}
+
+INLINE U16 get_history_ply(BOARD *board)
+{
+    return board->histply;
+}
+
 // Utils
+void    util_time_init(void);
 UINT    util_get_time(void);
+U64     util_get_time_ns(void);
+void    util_timed_cond_init(COND *cond);
+void    util_timed_cond_wait(COND *cond, MUTEX *mutex, U64 timeout);
 void    util_get_move_string(MOVE move, char *string);
 void    util_get_move_desc(MOVE move, char *string, int inc_file);
 MOVE    util_parse_move(GAME *game, char *move_string);
@@ -670,6 +1250,11 @@ void    util_draw_board(BOARD *board);
 // Evaluation
 int     evaluate(GAME *game, int alpha, int beta);
 void    clear_eval_table(GAME *game);
+void    eval_cache_alloc(GAME *game);
+void    eval_cache_free(GAME *game);
+int     eval_cache_set_size(int size_kb);
+int     pawn_cache_set_size(int size_kb);
+void    eval_cache_stats_print(U64 eval_probes, U64 eval_hits, U64 pawn_probes, U64 pawn_hits);
 void    eval_print(GAME *game);
 void    eval_print_values(EVALUATION *eval_values);
 int     eval_pst_pawn(int color, int pcsq);
@@ -678,6 +1263,26 @@ int     eval_pst_bishop(int pcsq);
 int     eval_pst_rook(int pcsq);
 int     eval_pst_queen(int color, int pcsq);
 int     eval_pst_king(int color, int pcsq);
+void    eval_pst_init(void);
+int     eval_pst_calc(BOARD *board, int color);
+int     eval_material_calc(BOARD *board, int color);
+
+// NNUE Evaluation
+int     nnue_load(char *file_name);
+int     nnue_is_loaded(void);
+int     nnue_evaluate(GAME *game);
+char    *nnue_simd_name(void);
+
+// Late move reductions table in 1/100 ply by depth and move count, built by lmr_init.
+#define LMR_MOVES   64
+EXTERN int lmr_reductions[MAX_DEPTH][LMR_MOVES];
+
+// Late move reductions parameters (1/100 ply).
+EXTERN int LMR_BASE;
+EXTERN int LMR_DIVISOR;
+EXTERN int LMR_HISTORY;
+EXTERN int LMR_IMPROVING;
+EXTERN int LMR_PV;
 
 // Evaluation Terms
 // Material
@@ -689,6 +1294,10 @@ EXTERN int SCORE_QUEEN;
 EXTERN int B_BISHOP_PAIR;
 EXTERN int B_TEMPO;
 
+// Material and PST values by piece/square, built from parameters by eval_pst_init.
+EXTERN int MATERIAL_SCORE[NUM_PIECES];
+EXTERN int PST_SCORE[COLORS][NUM_PIECES][64];
+
 // King
 EXTERN int B_PAWN_PROXIMITY;
 EXTERN int P_PAWN_SHIELD;
@@ -817,17 +1426,25 @@ MOVE    pgn_engine_move(GAME *game, PGN_MOVE *pgn_move);
 
 // Perf
 void    perft(int depth);
+void    perft_fast(BOARD *board, int depth, int threads, int hash_mb);
 void    perftx(void);
 void    perfty(void);
 void    perftz(void);
 
+// Tuning
+void    search_param_uci_options(void);
+int     search_param_set(char *name, int value);
+
 // Tests
 void    epd(char *file_name, SETTINGS *settings);
 void    eval_test(char *file_name);
+void    fuzz_test(char *file_name, int moves_per_position);
 
 #ifndef NDEBUG
 // Assert functions.
 int     valid_material(BOARD *board);
+int     valid_eval_accumulators(BOARD *board);
+int     nnue_accumulator_is_ok(GAME *game, NNUE_ACCUMULATOR *acc);
 int     valid_rank_file(void);
 int     valid_square(int square);
 int     valid_color(int color);
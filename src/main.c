@@ -34,6 +34,8 @@ void        settings_init(void);
 char        line[MAX_READ];
 char        command[MAX_READ] = { '\0' };
 char        syzygy_path[1024] = "";
+int         bench_elapsed = 0;
+U64         bench_nodes = 0;      // nodes of all threads in the last bench
 
 //-------------------------------------------------------------------------------------------------
 //  Main loop
@@ -54,6 +56,7 @@ int main(int argc, char *argv[])
     int         hash_size = 64; // Hash Table Size in MB
 
     printf("%s chess engine by %s - %s (type 'help' for information)\n", ENGINE, AUTHOR, VERSION);
+    printf("bitboard functions: %s, %s\n", bb_backend_name(), magic_backend_name());
 
     EVAL_PRINTING = FALSE;
 
@@ -78,14 +81,18 @@ int main(int argc, char *argv[])
     printf("   hash table: %d MB, threads: %d\n", hash_size, threads);
 
     // Initializations
+    util_time_init();
     srand((UINT)19810505);
     bb_init();
     bb_data_init();
     magic_init();
     eval_param_init();
+    eval_pst_init();
+    lmr_param_init();
+    lmr_init();
     book_init();
-    tt_init(hash_size);
     threads_init(threads);
+    tt_init(hash_size);
 #ifdef EGTB_SYZYGY
     if (strlen(syzygy_path) != 0) {
         if (tb_init(syzygy_path)) {
@@ -131,7 +138,8 @@ int main(int argc, char *argv[])
             }
 
             if (ponder_on && ponder_move != MOVE_NONE && is_valid(&main_game.board, ponder_move)) {
-                memcpy(&ponder_game, &main_game, sizeof(GAME));
+                copy_board(&ponder_game.board, &main_game.board);
+                game_share_caches(&ponder_game, &main_game);
                 make_move(&ponder_game.board, ponder_move);
                 if (!is_illegal(&ponder_game.board, ponder_move)) {
                     THREAD_CREATE(ponder_thread, ponder_search, &ponder_game);
@@ -187,9 +195,11 @@ int main(int argc, char *argv[])
             continue;
         }
         if (!strcmp(command, "level"))  {
-            // just get the "moves to go". will use "time" command to calculate move time.
-            sscanf(line, "level %d", &game_settings.moves_per_level);
+            // get the "moves to go" and increment. will use "time" command to calculate move time.
+            double increment = 0;
+            sscanf(line, "level %d %*s %lf", &game_settings.moves_per_level, &increment);
             if (game_settings.moves_per_level < 0) game_settings.moves_per_level = 0;
+            game_settings.increment = increment > 0 ? (UINT)(increment * 1000) : 0;
             continue;
         }
         if (!strcmp(command, "time"))  {
@@ -217,6 +227,10 @@ int main(int argc, char *argv[])
             printf("feature analyze=1\n");
             printf("feature option=\"Hash -spin 64 %d %d\"\n", MIN_HASH_SIZE, MAX_HASH_SIZE);
             printf("feature option=\"Threads -spin 1 %d %d\"\n", MIN_THREADS, MAX_THREADS);
+            printf("feature option=\"SharedHistory -check 0\"\n");
+            printf("feature option=\"EvalFile -file \"\"\"\n");
+            printf("feature option=\"EvalCache -spin %d %d %d\"\n", DEFAULT_EVAL_CACHE, MIN_EVAL_CACHE, MAX_EVAL_CACHE);
+            printf("feature option=\"PawnCache -spin %d %d %d\"\n", DEFAULT_PAWN_CACHE, MIN_EVAL_CACHE, MAX_EVAL_CACHE);
 #ifdef EGTB_SYZYGY
             printf("feature option=\"SyzygyPath -path \"\"\"\n");
 #endif
@@ -234,6 +248,32 @@ int main(int argc, char *argv[])
                 threads = valid_threads(threads);
                 threads_init(threads);
             }
+            if (strstr(line, "SharedHistory")) {
+                int shared = FALSE;
+                sscanf(line, "option SharedHistory=%d", &shared);
+                set_shared_history(shared);
+            }
+            if (strstr(line, "EvalCache")) {
+                int eval_cache = DEFAULT_EVAL_CACHE;
+                sscanf(line, "option EvalCache=%d", &eval_cache);
+                eval_cache_set_size(eval_cache);
+                threads_eval_cache_alloc();
+            }
+            if (strstr(line, "PawnCache")) {
+                int pawn_cache = DEFAULT_PAWN_CACHE;
+                sscanf(line, "option PawnCache=%d", &pawn_cache);
+                pawn_cache_set_size(pawn_cache);
+                threads_eval_cache_alloc();
+            }
+            if (strstr(line, "EvalFile")) {
+                char eval_file[MAX_READ] = "";
+                strcpy(eval_file, &line[strlen("option EvalFile=")]);
+                eval_file[strcspn(eval_file, "\r\n")] = '\0';
+                threads_clear_eval_table();
+                if (nnue_load(eval_file)) {
+                    printf("# using nnue evaluation file=%s (%s)\n", eval_file, nnue_simd_name());
+                }
+            }
 #ifdef EGTB_SYZYGY
             if (strstr(line, "SyzygyPath")) {
                 strcpy(syzygy_path, &line[strlen("option SyzygyPath=")]);
@@ -319,6 +359,18 @@ int main(int argc, char *argv[])
                 perft(perft_depth);
             continue;
         }
+        if (!strcmp(command, "perftb")) {
+            //  Fast perft from current position: bulk counting, hash table and threads.
+            int perft_threads = 1;
+            int perft_hash = 64;
+            perft_depth = 0;
+            sscanf(line, "perftb %d %d %d", &perft_depth, &perft_threads, &perft_hash);
+            if (perft_depth <= 0)
+                printf("syntax: perftb <depth> [threads] [hash MB]\n");
+            else
+                perft_fast(&main_game.board, perft_depth, valid_threads(perft_threads), MAX(0, perft_hash));
+            continue;
+        }
         if (!strcmp(command, "perftx")) {
             //  Display more detailed move count.
             perftx();
@@ -372,6 +424,54 @@ int main(int argc, char *argv[])
             bench(16, TRUE);
             continue;
         }
+        if (!strcmp(command, "smpstats")) {
+            //  Parallel search statistics: compare with a single thread bench
+            int smp_depth = 12;
+            sscanf(line, "smpstats %d", &smp_depth);
+            printf("running single thread bench (depth=%d)...\n", smp_depth);
+            threads_init(1);
+            double base_nps = bench(smp_depth, FALSE);
+            int base_time = bench_elapsed;
+            printf("running %d threads bench (depth=%d)...\n", threads, smp_depth);
+            threads_init(threads);
+            smp_stats_reset();
+            bench(smp_depth, FALSE);
+            smp_stats_print("", FALSE, base_nps);
+            printf("time to depth: 1 thread %d ms, %d threads %d ms, speedup %.2f\n", base_time, threads, bench_elapsed, (double)base_time / bench_elapsed);
+            continue;
+        }
+        if (!strcmp(command, "sortstats")) {
+            //  Move ordering statistics: score comparisons to sort move lists
+            int sort_depth = 12;
+            sscanf(line, "sortstats %d", &sort_depth);
+            printf("running bench (depth=%d)...\n", sort_depth);
+            select_stats_reset(TRUE);
+            bench(sort_depth, FALSE);
+            select_stats_print(bench_nodes);
+            select_stats_reset(FALSE);
+            continue;
+        }
+        if (!strcmp(command, "histbench")) {
+            //  Compare time to depth using per thread or shared history tables
+            int hist_depth = 14;
+            int hist_threads[] = { 8, 32, 64 };
+            int shared = get_shared_history();
+            sscanf(line, "histbench %d", &hist_depth);
+            printf("bench depth %d: time to depth in ms\n", hist_depth);
+            printf("threads  per thread  shared   ratio\n");
+            for (int i = 0; i < 3; i++) {
+                threads_init(hist_threads[i]);
+                set_shared_history(FALSE);
+                bench(hist_depth, FALSE);
+                int own_time = bench_elapsed;
+                set_shared_history(TRUE);
+                bench(hist_depth, FALSE);
+                printf("%7d  %10d  %6d  %6.2f\n", hist_threads[i], own_time, bench_elapsed, (double)own_time / bench_elapsed);
+            }
+            set_shared_history(shared);
+            threads_init(threads);
+            continue;
+        }
         if (!strcmp(command, "speed")) {
             //  Measure engine speed
             if (hash_size != 64) {
@@ -413,6 +513,16 @@ int main(int argc, char *argv[])
             eval_test(epd_file);
             continue;
         }
+        if (!strcmp(command, "fuzz")) {
+            //  Test hash move validation with random moves for epd positions.
+            int fuzz_count = 10000;
+            if (sscanf(line, "fuzz %s %d", epd_file, &fuzz_count) < 1) {
+                printf("syntax: fuzz <epd file name> [moves per position]\n");
+                continue;
+            }
+            fuzz_test(epd_file, fuzz_count);
+            continue;
+        }
         if (!strcmp(command, "help")) {
             printf("Tucano supports XBoard/Winboard or UCI protocols.\n\n");
             printf("Other commands that can be used:\n\n");
@@ -420,8 +530,13 @@ int main(int argc, char *argv[])
             printf("          eval: print evaluation score for current position\n");
             printf("         post1: enable formatted search information\n");
             printf("epd <filename>: locate best move for epd poistions in the file\n");
+            printf("fuzz <filename> [n]: test hash move validation with n random moves per position\n");
             printf("     perft <n>: show perft move count from current position.\n");
+            printf("perftb <n> [t] [h]: fast perft from current position with t threads and h MB hash.\n");
             printf("                other perft commands: perftx, perfty, perftz\n");
+            printf("  smpstats <n>: parallel search statistics and speedup for bench at depth n\n");
+            printf(" histbench <n>: compare per thread and shared history at 8/32/64 threads\n");
+            printf(" sortstats <n>: move ordering comparisons per node for bench at depth n\n");
             printf("\n");
             printf("\n");
             printf("Command line options:\n\n");
@@ -458,6 +573,10 @@ void settings_init(void)
     game_settings.max_depth = MAX_DEPTH;
     game_settings.post_flag = POST_DEFAULT;
     game_settings.use_book = FALSE;
+    game_settings.increment = 0;
+    game_settings.max_nodes = 0;
+    game_settings.mate_in = 0;
+    game_settings.search_moves_count = 0;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -488,7 +607,7 @@ double bench(int depth, int print)
         NULL
     };
 
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "bench.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return 0;
@@ -501,6 +620,10 @@ double bench(int depth, int print)
     settings.single_move_time = MAX_TIME;
     settings.total_move_time = MAX_TIME;
     settings.use_book = FALSE;
+    settings.increment = 0;
+    settings.max_nodes = 0;
+    settings.mate_in = 0;
+    settings.search_moves_count = 0;
 
     if (print) printf("Benchmark (depth=%d)\n", depth);
 
@@ -508,7 +631,15 @@ double bench(int depth, int print)
     for (int i = 0; test[i]; i++) total_tests++;
 
     U64     nodes = 0;
+    U64     all_nodes = 0;
     int     elapsed = 1;
+    U64     eval_probes = 0;
+    U64     eval_hits = 0;
+    U64     pawn_probes = 0;
+    U64     pawn_hits = 0;
+
+    tt_stats_reset(print);
+    threads_stats_reset();
 
     for (int i = 0; test[i]; i++) {
         if (print) printf("%d/%d) %s\n", i + 1, total_tests, test[i]);
@@ -518,13 +649,28 @@ double bench(int depth, int print)
         search_run(game, &settings);
 
         nodes += game->search.nodes;
+        all_nodes += game->search.nodes + get_additional_threads_nodes();
         elapsed += game->search.elapsed_time;
+        eval_probes += game->eval_cache.probes;
+        eval_hits += game->eval_cache.hits;
+        pawn_probes += game->pawn_cache.probes;
+        pawn_hits += game->pawn_cache.hits;
     }
 
     double nps = 1000.0 * (double)nodes / elapsed;
 
+    bench_elapsed = elapsed;
+    bench_nodes = all_nodes;
+
     if (print) printf("\nSignature: %" PRIu64 "  Elapsed time: %3.2f secs  Nodes/sec: %4.0fk\n", nodes, (double)elapsed / 1000.0, nps / 1000.0);
+    if (print) tt_stats_print();
+    if (print) eval_cache_stats_print(eval_probes, eval_hits, pawn_probes, pawn_hits);
+    if (print) threads_stats_print();
+
+    tt_stats_reset(FALSE);
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     return nps;
@@ -30,8 +30,6 @@
 // epsq or pwsq: 6 bits - ep square or pawn square (ep square when is pawn 2 square move, pawn square when is EP Capture)
 // quiet: 1 bit - flag to indicate quiet moves.
 
-#define QUIET_BIT    0x80000000
-
 //-------------------------------------------------------------------------------------------------
 //    Quiet move.
 //-------------------------------------------------------------------------------------------------
@@ -203,116 +201,4 @@ MOVE pack_null_move(void)
     return (MOVE)(MT_NULL << 12);
 }
 
-//-------------------------------------------------------------------------------------------------
-//    Return the move "from square"
-//-------------------------------------------------------------------------------------------------
-int unpack_from(MOVE move)
-{
-    return (move >> 6) & 0x3F;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return the move "to square"
-//-------------------------------------------------------------------------------------------------
-int unpack_to(MOVE move)
-{
-    return move & 0x3F;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return the move type
-//-------------------------------------------------------------------------------------------------
-int unpack_type(MOVE move)
-{
-    return (move >> 12) & 0x0F;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return the moving piece
-//-------------------------------------------------------------------------------------------------
-int unpack_piece(MOVE move)
-{
-    return (move >> 16) & 0x07;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return capture piece
-//-------------------------------------------------------------------------------------------------
-int unpack_capture(MOVE move)
-{
-    return (move >> 19) & 0x07;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return promotion piece
-//-------------------------------------------------------------------------------------------------
-int unpack_prom_piece(MOVE move)
-{
-    return (move >> 22) & 0x07;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return en passant square
-//-------------------------------------------------------------------------------------------------
-int unpack_ep_square(MOVE move)
-{
-    return (move >> 25) & 0x3F;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Return en passant pawn square
-//-------------------------------------------------------------------------------------------------
-int unpack_ep_pawn_square(MOVE move)
-{
-    return (move >> 25) & 0x3F;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Indicates if it is quiet move.
-//-------------------------------------------------------------------------------------------------
-int move_is_quiet(MOVE move)
-{
-    return move & QUIET_BIT;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Indicates if it is castle move.
-//-------------------------------------------------------------------------------------------------
-int move_is_castle(MOVE move)
-{
-    int        type = unpack_type(move);
-
-    return type == MT_CSWKS || type == MT_CSWQS || type == MT_CSBKS || type == MT_CSBQS;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Indicates a promotion move (pawn move or pawn capture)
-//-------------------------------------------------------------------------------------------------
-int move_is_promotion(MOVE move)
-{
-    int        type = unpack_type(move);
-
-    return type == MT_PROMO || type == MT_CPPRM;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Indicates en passant capture move
-//-------------------------------------------------------------------------------------------------
-int move_is_en_passant(MOVE move)
-{
-    int        type = unpack_type(move);
-
-    return type == MT_EPCAP;
-}
-
-//-------------------------------------------------------------------------------------------------
-//    Indicates capture moves
-//-------------------------------------------------------------------------------------------------
-int move_is_capture(MOVE move)
-{
-    int        type = unpack_type(move);
-
-    return type == MT_CAPPC || type == MT_CPPRM || type == MT_EPCAP;
-}
-
 //END
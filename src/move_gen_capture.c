@@ -25,7 +25,7 @@ void    gen_white_pawn_captures(BOARD *board, MOVE_LIST *ml);
 void    gen_black_pawn_captures(BOARD *board, MOVE_LIST *ml);
 
 //-------------------------------------------------------------------------------------------------
-//  Generate capture moves.
+//  Generate legal capture moves when not in check. ml->pins must have the pinned pieces.
 //-------------------------------------------------------------------------------------------------
 void gen_caps(BOARD *board, MOVE_LIST *ml)
 {
@@ -33,6 +33,7 @@ void gen_caps(BOARD *board, MOVE_LIST *ml)
     int     from, to;
     int     turn = side_on_move(board);
     int     opp = flip_color(turn);
+    int     king_sq = king_square(board, turn);
 
     assert(ml != NULL);
 
@@ -42,8 +43,8 @@ void gen_caps(BOARD *board, MOVE_LIST *ml)
     else
         gen_black_pawn_captures(board, ml);
 
-    //  Knight
-    piece.u64 = knight_bb(board, turn);
+    //  Knight: a pinned knight cannot move.
+    piece.u64 = knight_bb(board, turn) & ~ml->pins;
     while (piece.u64) {
         from = bb_first(piece);
         attacks.u64 = knight_moves_bb(from) & all_pieces_bb(board, opp);
@@ -61,6 +62,7 @@ void gen_caps(BOARD *board, MOVE_LIST *ml)
         from = bb_first(piece);
 
         attacks.u64 = bb_rook_attacks(from, occupied_bb(board)) & all_pieces_bb(board, opp);
+        if (bb_is_one(ml->pins, from)) attacks.u64 &= pin_mask_bb(king_sq, from);
         while (attacks.u64) {
             to = (turn == WHITE ? bb_first(attacks) : bb_last(attacks));
             add_move(ml, pack_capture(piece_on_square(board, turn, from), piece_on_square(board, opp, to), from, to));
@@ -75,6 +77,7 @@ void gen_caps(BOARD *board, MOVE_LIST *ml)
     while (piece.u64) {
         from = bb_first(piece);
         attacks.u64 = bb_bishop_attacks(from, occupied_bb(board)) & all_pieces_bb(board, opp);
+        if (bb_is_one(ml->pins, from)) attacks.u64 &= pin_mask_bb(king_sq, from);
         while (attacks.u64) {
             to = (turn == WHITE ? bb_first(attacks) : bb_last(attacks));
             add_move(ml, pack_capture(piece_on_square(board, turn, from), piece_on_square(board, opp, to), from, to));
@@ -84,11 +87,12 @@ void gen_caps(BOARD *board, MOVE_LIST *ml)
     }
 
     //  King
-    from = king_square(board, turn);
+    from = king_sq;
     attacks.u64 = king_moves_bb(from) & all_pieces_bb(board, opp);
     while (attacks.u64) {
         to = (turn == WHITE ? bb_first(attacks) : bb_last(attacks));
-        add_move(ml, pack_capture(KING, piece_on_square(board, opp, to), from, to));
+        if (!is_square_attacked(board, to, opp, occupied_bb(board) ^ square_bb(from)))
+            add_move(ml, pack_capture(KING, piece_on_square(board, opp, to), from, to));
         bb_clear_bit(&attacks.u64, to);
     }
 }
@@ -101,9 +105,11 @@ void gen_white_pawn_captures(BOARD *board, MOVE_LIST *ml)
     BBIX    moves, attacks, ep_capture;
     int     from, to;
     int     opp = flip_color(side_on_move(board));
+    int     king_sq = king_square(board, side_on_move(board));
+    MOVE    move;
 
     // promotions
-    moves.u64 = ((pawn_bb(board, WHITE) & BB_RANK_7) << 8) & empty_bb(board);
+    moves.u64 = ((pawn_push_bb(board, ml, WHITE) & BB_RANK_7) << 8) & empty_bb(board);
     while (moves.u64) {
         to = bb_first(moves);
         add_all_promotions(ml, to + 8, to);
@@ -117,15 +123,18 @@ void gen_white_pawn_captures(BOARD *board, MOVE_LIST *ml)
     while (attacks.u64) {
         to = bb_first(attacks);
         from = to + 9;
-        if (to < 8)
-            add_all_capture_promotions(ml, from, to, piece_on_square(board, BLACK, to));
-        else
-            add_move(ml, pack_capture(PAWN, piece_on_square(board, BLACK, to), from, to));
+        if (!bb_is_one(ml->pins, from) || bb_is_one(pin_mask_bb(king_sq, from), to)) {
+            if (to < 8)
+                add_all_capture_promotions(ml, from, to, piece_on_square(board, BLACK, to));
+            else
+                add_move(ml, pack_capture(PAWN, piece_on_square(board, BLACK, to), from, to));
+        }
         bb_clear_bit(&attacks.u64, to);
     }
     if (ep_capture.u64) {
         to = bb_last(ep_capture);
-        add_move(ml, pack_en_passant_capture(to + 9, to, to + 8));
+        move = pack_en_passant_capture(to + 9, to, to + 8);
+        if (is_en_passant_legal(board, move)) add_move(ml, move);
     }
 
     // attacks northeast
@@ -135,15 +144,18 @@ void gen_white_pawn_captures(BOARD *board, MOVE_LIST *ml)
     while (attacks.u64) {
         to = bb_first(attacks);
         from = to + 7;
-        if (to < 8)
-            add_all_capture_promotions(ml, from, to, piece_on_square(board, BLACK, to));
-        else
-            add_move(ml, pack_capture(PAWN, piece_on_square(board, BLACK, to), from, to));
+        if (!bb_is_one(ml->pins, from) || bb_is_one(pin_mask_bb(king_sq, from), to)) {
+            if (to < 8)
+                add_all_capture_promotions(ml, from, to, piece_on_square(board, BLACK, to));
+            else
+                add_move(ml, pack_capture(PAWN, piece_on_square(board, BLACK, to), from, to));
+        }
         bb_clear_bit(&attacks.u64, to);
     }
     if (ep_capture.u64) {
         to = bb_last(ep_capture);
-        add_move(ml, pack_en_passant_capture(to + 7, to, to + 8));
+        move = pack_en_passant_capture(to + 7, to, to + 8);
+        if (is_en_passant_legal(board, move)) add_move(ml, move);
     }
 }
 
@@ -155,9 +167,11 @@ void gen_black_pawn_captures(BOARD *board, MOVE_LIST *ml)
     BBIX    moves, attacks, ep_capture;
     int     from, to;
     int     opp = flip_color(side_on_move(board));
+    int     king_sq = king_square(board, side_on_move(board));
+    MOVE    move;
 
     //  promotions
-       moves.u64 = ((pawn_bb(board, BLACK) & BB_RANK_2) >> 8) & empty_bb(board);
+    moves.u64 = ((pawn_push_bb(board, ml, BLACK) & BB_RANK_2) >> 8) & empty_bb(board);
     while (moves.u64) {
         to = bb_last(moves);
         add_all_promotions(ml, to - 8, to);
@@ -170,15 +184,18 @@ void gen_black_pawn_captures(BOARD *board, MOVE_LIST *ml)
     while (attacks.u64) {
         to = bb_last(attacks);
         from = to - 9;
-        if (to > 55)
-            add_all_capture_promotions(ml, from, to, piece_on_square(board, WHITE, to));
-        else
-            add_move(ml, pack_capture(PAWN, piece_on_square(board, WHITE, to), from, to));
+        if (!bb_is_one(ml->pins, from) || bb_is_one(pin_mask_bb(king_sq, from), to)) {
+            if (to > 55)
+                add_all_capture_promotions(ml, from, to, piece_on_square(board, WHITE, to));
+            else
+                add_move(ml, pack_capture(PAWN, piece_on_square(board, WHITE, to), from, to));
+        }
         bb_clear_bit(&attacks.u64, to);
     }
     if (ep_capture.u64) {
         to = bb_last(ep_capture);
-        add_move(ml, pack_en_passant_capture(to - 9, to, to - 8));
+        move = pack_en_passant_capture(to - 9, to, to - 8);
+        if (is_en_passant_legal(board, move)) add_move(ml, move);
     }
     // attacks southwest
     attacks.u64 = (pawn_bb(board, BLACK) & BB_NO_AFILE) >> 7;
@@ -187,15 +204,18 @@ void gen_black_pawn_captures(BOARD *board, MOVE_LIST *ml)
     while (attacks.u64) {
         to = bb_last(attacks);
         from = to - 7;
-        if (to > 55)
-            add_all_capture_promotions(ml, from, to, piece_on_square(board, WHITE, to));
-        else
-            add_move(ml, pack_capture(PAWN, piece_on_square(board, WHITE, to), from, to));
+        if (!bb_is_one(ml->pins, from) || bb_is_one(pin_mask_bb(king_sq, from), to)) {
+            if (to > 55)
+                add_all_capture_promotions(ml, from, to, piece_on_square(board, WHITE, to));
+            else
+                add_move(ml, pack_capture(PAWN, piece_on_square(board, WHITE, to), from, to));
+        }
         bb_clear_bit(&attacks.u64, to);
     }
     if (ep_capture.u64) {
         to = bb_last(ep_capture);
-        add_move(ml, pack_en_passant_capture(to - 7, to, to - 8));
+        move = pack_en_passant_capture(to - 7, to, to - 8);
+        if (is_en_passant_legal(board, move)) add_move(ml, move);
     }
 }
 
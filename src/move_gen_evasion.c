@@ -23,7 +23,8 @@
 void    gm_evasion_king_moves(BOARD *board, MOVE_LIST *ml, int king_square);
 
 //-------------------------------------------------------------------------------------------------
-//  When in check generate evasion moves.
+//  When in check generate legal evasion moves. ml->pins must have the pinned pieces: they can
+//  never capture or block the checking piece.
 //-------------------------------------------------------------------------------------------------
 void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
 {
@@ -38,6 +39,7 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
     int     ep_pos[COLORS] = {-8, +8};
     int     myc = side_on_move(board);
     int     opp = flip_color(myc);
+    U64     not_pinned = ~ml->pins;
 
     assert(is_incheck(board, side_on_move(board)));
 
@@ -87,28 +89,28 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
     int attacker_piece = piece_on_square(board, opp, attack_square);
 
     //  capture with knight
-    temp.u64 = knight_moves_bb(attack_square) & knight_bb(board, myc);
+    temp.u64 = knight_moves_bb(attack_square) & knight_bb(board, myc) & not_pinned;
     while (temp.u64) {
         idx = bb_last(temp);
         add_move(ml, pack_capture(KNIGHT, attacker_piece, idx, attack_square));
         bb_clear_bit(&temp.u64, idx);
     }
     //  capture with queen or rook
-    temp.u64 = bb_rook_attacks(attack_square, occupied_bb(board)) & queen_rook_bb(board, myc);
+    temp.u64 = bb_rook_attacks(attack_square, occupied_bb(board)) & queen_rook_bb(board, myc) & not_pinned;
     while (temp.u64) {
         idx = bb_last(temp);
         add_move(ml, pack_capture(piece_on_square(board, myc, idx), attacker_piece, idx, attack_square));
         bb_clear_bit(&temp.u64, idx);
     }
     //  capture with queen or bishop
-    temp.u64 = bb_bishop_attacks(attack_square, occupied_bb(board)) & queen_bishop_bb(board, myc);
+    temp.u64 = bb_bishop_attacks(attack_square, occupied_bb(board)) & queen_bishop_bb(board, myc) & not_pinned;
     while (temp.u64) {
         idx = bb_last(temp);
         add_move(ml, pack_capture(piece_on_square(board, myc, idx), attacker_piece, idx, attack_square));
         bb_clear_bit(&temp.u64, idx);
     }
     //  capture with pawn including capture/promotion
-    temp.u64 = pawn_attack_bb(myc, attack_square) & pawn_bb(board, myc);
+    temp.u64 = pawn_attack_bb(myc, attack_square) & pawn_bb(board, myc) & not_pinned;
     while (temp.u64)  {
         idx = bb_last(temp);
         if (attack_square < 8 || attack_square > 55)
@@ -121,10 +123,14 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
     if (attacker_piece == PAWN && ep_square_bb(board)) {
         idx = ep_square(board);
         if (attack_square + ep_pos[myc] == idx) {
-            if (get_file(attack_square) > FILEA && piece_on_square(board, myc, attack_square - 1) == PAWN)
-                add_move(ml, pack_en_passant_capture(attack_square - 1, idx, attack_square));
-            if (get_file(attack_square) < FILEH && piece_on_square(board, myc, attack_square + 1) == PAWN)
-                add_move(ml, pack_en_passant_capture(attack_square + 1, idx, attack_square));
+            if (get_file(attack_square) > FILEA && piece_on_square(board, myc, attack_square - 1) == PAWN) {
+                MOVE move = pack_en_passant_capture(attack_square - 1, idx, attack_square);
+                if (is_en_passant_legal(board, move)) add_move(ml, move);
+            }
+            if (get_file(attack_square) < FILEH && piece_on_square(board, myc, attack_square + 1) == PAWN) {
+                MOVE move = pack_en_passant_capture(attack_square + 1, idx, attack_square);
+                if (is_en_passant_legal(board, move)) add_move(ml, move);
+            }
         }
     }
 
@@ -134,21 +140,21 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
         block_square = bb_first(attack_path);
 
         //  block with knight
-        temp.u64 = knight_moves_bb(block_square) & knight_bb(board, myc);
+        temp.u64 = knight_moves_bb(block_square) & knight_bb(board, myc) & not_pinned;
         while (temp.u64) {
             idx = bb_last(temp);
             add_move(ml, pack_quiet(KNIGHT, idx, block_square));
             bb_clear_bit(&temp.u64, idx);
         }
         //  block with queen or rook
-        temp.u64 = bb_rook_attacks(block_square, occupied_bb(board)) & queen_rook_bb(board, myc);
+        temp.u64 = bb_rook_attacks(block_square, occupied_bb(board)) & queen_rook_bb(board, myc) & not_pinned;
         while (temp.u64) {
             idx = bb_last(temp);
             add_move(ml, pack_quiet(piece_on_square(board, myc, idx), idx, block_square));
             bb_clear_bit(&temp.u64, idx);
         }
         //  block with queen or bishop
-        temp.u64 = bb_bishop_attacks(block_square, occupied_bb(board)) & queen_bishop_bb(board, myc);
+        temp.u64 = bb_bishop_attacks(block_square, occupied_bb(board)) & queen_bishop_bb(board, myc) & not_pinned;
         while (temp.u64)  {
             idx = bb_last(temp);
             add_move(ml, pack_quiet(piece_on_square(board, myc, idx), idx, block_square));
@@ -156,7 +162,7 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
         }
         //  block with pawn moves, including promotions
         if (side_on_move(board) == WHITE) {
-            pawns = pawn_bb(board, WHITE);
+            pawns = pawn_bb(board, WHITE) & not_pinned;
             moves = (pawns << 8) & empty_bb(board);
             moves2sq = (((moves & BB_RANK_3) << 8) & empty_bb(board));
             if (moves & square_bb(block_square)) {
@@ -169,7 +175,7 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
                 add_move(ml, pack_pawn_2square(block_square + 16, block_square, block_square + 8));
         }
         else {
-            pawns = pawn_bb(board, BLACK);
+            pawns = pawn_bb(board, BLACK) & not_pinned;
             moves = (pawns >> 8) & empty_bb(board);
             moves2sq = (((moves & BB_RANK_6) >> 8) & empty_bb(board));
             if (moves & square_bb(block_square)) {
@@ -187,24 +193,28 @@ void gen_check_evasions(BOARD *board, MOVE_LIST *ml)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Generate king evasion moves.
+//  Generate king evasion moves. The king is removed from the occupancy, so squares behind it on
+//  the line of a sliding attacker are not considered safe.
 //-------------------------------------------------------------------------------------------------
 void gm_evasion_king_moves(BOARD *board, MOVE_LIST *ml, int king_square)
 {
     BBIX    temp;
     int     to;
     int     opp = flip_color(side_on_move(board));
+    U64     occup = occupied_bb(board) ^ square_bb(king_square);
 
     temp.u64 = king_moves_bb(king_square) & all_pieces_bb(board, flip_color(side_on_move(board)));
     while (temp.u64) {
         to = bb_first(temp);
-        add_move(ml, pack_capture(KING, piece_on_square(board, opp, to), king_square, to));
+        if (!is_square_attacked(board, to, opp, occup))
+            add_move(ml, pack_capture(KING, piece_on_square(board, opp, to), king_square, to));
         bb_clear_bit(&temp.u64, to);
     }
     temp.u64 = king_moves_bb(king_square) & empty_bb(board);
     while (temp.u64) {
         to = bb_first(temp);
-        add_move(ml, pack_quiet(KING, king_square, to));
+        if (!is_square_attacked(board, to, opp, occup))
+            add_move(ml, pack_quiet(KING, king_square, to));
         bb_clear_bit(&temp.u64, to);
     }
 }
@@ -25,7 +25,7 @@ void    gen_white_pawn_moves(BOARD *board, MOVE_LIST *ml, U64 empty_squares);
 void    gen_black_pawn_moves(BOARD *board, MOVE_LIST *ml, U64 empty_squares);
 
 //-------------------------------------------------------------------------------------------------
-//  Generate moves.
+//  Generate legal moves when not in check. ml->pins must have the pinned pieces (find_pins).
 //-------------------------------------------------------------------------------------------------
 void gen_moves(BOARD *board, MOVE_LIST *ml)
 {
@@ -34,6 +34,7 @@ void gen_moves(BOARD *board, MOVE_LIST *ml)
     BBIX    moves;
     U64     empty_squares = empty_bb(board);
     int     turn = side_on_move(board);
+    int     king_sq = king_square(board, turn);
 
     //  Pawn
     if (turn == WHITE)
@@ -41,8 +42,8 @@ void gen_moves(BOARD *board, MOVE_LIST *ml)
     else
         gen_black_pawn_moves(board, ml, empty_squares);
 
-    //  Knight
-    piece.u64 = knight_bb(board, turn);
+    //  Knight: a pinned knight cannot move.
+    piece.u64 = knight_bb(board, turn) & ~ml->pins;
     while (piece.u64) {
         from = bb_last(piece);
         moves.u64 = knight_moves_bb(from) & empty_squares;
@@ -60,6 +61,7 @@ void gen_moves(BOARD *board, MOVE_LIST *ml)
         from = bb_first(piece);
 
         moves.u64 = bb_rook_attacks(from, occupied_bb(board)) & empty_squares;
+        if (bb_is_one(ml->pins, from)) moves.u64 &= pin_mask_bb(king_sq, from);
         while (moves.u64) {
             to = (turn == WHITE ? bb_first(moves) : bb_last(moves));
             add_move(ml, pack_quiet(piece_on_square(board, turn, from), from, to));
@@ -75,6 +77,7 @@ void gen_moves(BOARD *board, MOVE_LIST *ml)
         from = bb_first(piece);
 
         moves.u64 = bb_bishop_attacks(from, occupied_bb(board)) & empty_squares;
+        if (bb_is_one(ml->pins, from)) moves.u64 &= pin_mask_bb(king_sq, from);
         while (moves.u64) {
             to = (turn == WHITE ? bb_first(moves) : bb_last(moves));
             add_move(ml, pack_quiet(piece_on_square(board, turn, from), from, to));
@@ -85,25 +88,38 @@ void gen_moves(BOARD *board, MOVE_LIST *ml)
     }
 
     //  King
-    from = king_square(board, turn);
+    from = king_sq;
     moves.u64 = king_moves_bb(from) & empty_squares;
     while (moves.u64) {
         to = bb_first(moves);
-        add_move(ml, pack_quiet(KING, from, to));
+        if (!is_square_attacked(board, to, flip_color(turn), occupied_bb(board) ^ square_bb(from)))
+            add_move(ml, pack_quiet(KING, from, to));
         bb_clear_bit(&moves.u64, to);
     }
 
     //  Castle
     if (turn == WHITE) {
-        if (can_generate_castle_ks(board, WHITE)) add_move(ml, pack_castle(from, G1, MT_CSWKS));
-        if (can_generate_castle_qs(board, WHITE)) add_move(ml, pack_castle(from, C1, MT_CSWQS));
+        if (can_generate_castle_ks(board, WHITE) && !is_white_kingside_attacked(board)) add_move(ml, pack_castle(from, G1, MT_CSWKS));
+        if (can_generate_castle_qs(board, WHITE) && !is_white_queenside_attacked(board)) add_move(ml, pack_castle(from, C1, MT_CSWQS));
     }
     else {
-        if (can_generate_castle_ks(board, BLACK)) add_move(ml, pack_castle(from, G8, MT_CSBKS));
-        if (can_generate_castle_qs(board, BLACK)) add_move(ml, pack_castle(from, C8, MT_CSBQS));
+        if (can_generate_castle_ks(board, BLACK) && !is_black_kingside_attacked(board)) add_move(ml, pack_castle(from, G8, MT_CSBKS));
+        if (can_generate_castle_qs(board, BLACK) && !is_black_queenside_attacked(board)) add_move(ml, pack_castle(from, C8, MT_CSBQS));
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Pawns that can move forward: not pinned, or pinned on the king file.
+//-------------------------------------------------------------------------------------------------
+U64 pawn_push_bb(BOARD *board, MOVE_LIST *ml, int color)
+{
+    U64 pawns = pawn_bb(board, color);
+    U64 pinned = pawns & ml->pins;
+
+    if (pinned) pawns ^= pinned & ~(BB_FILE_A >> get_file(king_square(board, color)));
+    return pawns;
+}
+
 //-------------------------------------------------------------------------------------------------
 //  White pawns
 //-------------------------------------------------------------------------------------------------
@@ -113,7 +129,7 @@ void gen_white_pawn_moves(BOARD *board, MOVE_LIST *ml, U64 empty_squares)
     BBIX    moves2sq;
     int     to;
 
-    moves1sq.u64 = ((pawn_bb(board, WHITE) & ~BB_RANK_7) << 8) & empty_squares;
+    moves1sq.u64 = ((pawn_push_bb(board, ml, WHITE) & ~BB_RANK_7) << 8) & empty_squares;
     moves2sq.u64 = (((moves1sq.u64 & BB_RANK_3) << 8) & empty_squares);
     //  1 square move
     while (moves1sq.u64) {
@@ -138,7 +154,7 @@ void gen_black_pawn_moves(BOARD *board, MOVE_LIST *ml, U64 empty_squares)
     BBIX    moves2sq;
     int     to;
 
-    moves1sq.u64 = ((pawn_bb(board, BLACK) & ~BB_RANK_2) >> 8) & empty_squares;
+    moves1sq.u64 = ((pawn_push_bb(board, ml, BLACK) & ~BB_RANK_2) >> 8) & empty_squares;
     moves2sq.u64 = (((moves1sq.u64 & BB_RANK_6) >> 8) & empty_squares);
 
     // 1 square move
@@ -21,17 +21,155 @@
 //  Move ordering: history heuristic, killers
 //-------------------------------------------------------------------------------------------------
 
+int     cutoff_percent(MOVE_ORDER *move_order, BOARD *board, MOVE move, int none);
+MOVE    cont_move(BOARD *board, int plies);
+CONT_HISTORY *cont_history_alloc(void);
+void    cont_history_inc(MOVE_ORDER *move_order, int *search_count, int *cutoff_count, int cutoff);
+
+CACHE_ALIGN HISTORY_TABLE shared_history;
+CONT_HISTORY *shared_cont_history = NULL;
+int         use_shared_history = FALSE;
+
+//  Shared tables are updated with relaxed atomics, own tables are updated directly.
+#define HISTORY_INC(mo, counter)    { if ((mo)->shared) ATOMIC_ADD(&(counter), 1); else (counter) += 1; }
+
+//  Continuation history is kept for the whole session. An entry is halved when its search count
+//  reaches this value, so older games and searches count less.
+#define CONT_HISTORY_MAX    65536
+
+//-------------------------------------------------------------------------------------------------
+//  Select shared or per thread history tables for the next searches.
+//-------------------------------------------------------------------------------------------------
+void set_shared_history(int shared)
+{
+    if (shared && shared_cont_history == NULL) shared_cont_history = cont_history_alloc();
+    use_shared_history = shared;
+}
+
+int get_shared_history(void)
+{
+    return use_shared_history;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Allocate continuation history table, cleared.
+//-------------------------------------------------------------------------------------------------
+CONT_HISTORY *cont_history_alloc(void)
+{
+    CONT_HISTORY *cont_history = (CONT_HISTORY *)calloc(1, sizeof(CONT_HISTORY));
+    if (cont_history == NULL) {
+        printf("no memory for continuation history!");
+        exit(-1);
+    }
+    return cont_history;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Allocate the continuation history of a game once, and select the history tables. An existing
+//  table is kept as it is. The game data must start zeroed.
+//-------------------------------------------------------------------------------------------------
+void move_order_alloc(MOVE_ORDER *move_order)
+{
+    if (move_order->own_cont_history == NULL)
+        move_order->own_cont_history = cont_history_alloc();
+    init_move_order(move_order);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Release continuation history.
+//-------------------------------------------------------------------------------------------------
+void move_order_free(MOVE_ORDER *move_order)
+{
+    free(move_order->own_cont_history);
+    move_order->own_cont_history = NULL;
+    move_order->cont_history = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Select the history tables. Called when a game is initialised, so the table pointers are
+//  always valid, and again before each search in case the shared history option changed.
+//-------------------------------------------------------------------------------------------------
+void init_move_order(MOVE_ORDER *move_order)
+{
+    if (use_shared_history) {
+        move_order->history = &shared_history;
+        move_order->cont_history = shared_cont_history;
+        move_order->shared = TRUE;
+    }
+    else {
+        move_order->history = &move_order->own_history;
+        move_order->cont_history = move_order->own_cont_history;
+        move_order->shared = FALSE;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear killer moves only. History tables are kept.
+//-------------------------------------------------------------------------------------------------
+void clear_killers(MOVE_ORDER *move_order)
+{
+    memset(move_order->killers, 0, sizeof(move_order->killers));
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear move ordering data of a game for a new game and select the history table. Continuation
+//  history is not cleared, it ages as it is updated. Between searches of the same game only
+//  killers are cleared.
+//-------------------------------------------------------------------------------------------------
+void clear_move_order(MOVE_ORDER *move_order)
+{
+    clear_killers(move_order);
+    init_move_order(move_order);
+    memset(&move_order->own_history, 0, sizeof(HISTORY_TABLE));
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear shared history table for a new game. Threads are idle.
+//-------------------------------------------------------------------------------------------------
+void clear_shared_history(void)
+{
+    memset(&shared_history, 0, sizeof(HISTORY_TABLE));
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Count a search of a move in a continuation history entry, and the cutoff if it caused one.
+//  The entry is halved when it gets large: previous searches still count, with lower weight.
+//-------------------------------------------------------------------------------------------------
+void cont_history_inc(MOVE_ORDER *move_order, int *search_count, int *cutoff_count, int cutoff)
+{
+    HISTORY_INC(move_order, *search_count);
+    if (cutoff) HISTORY_INC(move_order, *cutoff_count);
+    if (ATOMIC_LOAD(search_count) >= CONT_HISTORY_MAX) {
+        ATOMIC_STORE(search_count, ATOMIC_LOAD(search_count) / 2);
+        ATOMIC_STORE(cutoff_count, ATOMIC_LOAD(cutoff_count) / 2);
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Update history table and killer move list for quiet moves.
 //-------------------------------------------------------------------------------------------------
 void save_beta_cutoff_data(MOVE_ORDER *move_order, int color, int ply, MOVE best_move, MOVE_LIST *ml, MOVE previous_move)
 {
+    HISTORY_TABLE *history = move_order->history;
+    CONT_HISTORY *cont_history = move_order->cont_history;
+
     // Update good history for best move found
     int mvpc = unpack_piece(best_move);
     int tosq = unpack_to(best_move);
 
-    move_order->search_count[color][mvpc][tosq] += 1;
-    move_order->beta_cutoff_count[color][mvpc][tosq] += 1;
+    HISTORY_INC(move_order, history->search_count[color][mvpc][tosq]);
+    HISTORY_INC(move_order, history->beta_cutoff_count[color][mvpc][tosq]);
+
+    // Continuation history after the last moves made
+    MOVE cont[CONT_PLIES];
+    for (int p = 0; p < CONT_PLIES; p++) {
+        cont[p] = cont_move(ml->board, p + 1);
+        if (cont[p] == MOVE_NONE) continue;
+        int pcpc = unpack_piece(cont[p]);
+        int pcsq = unpack_to(cont[p]);
+        cont_history_inc(move_order, &cont_history->search_count[p][color][pcpc][pcsq][mvpc][tosq],
+            &cont_history->cutoff_count[p][color][pcpc][pcsq][mvpc][tosq], TRUE);
+    }
 
     if (move_order->killers[ply][color][0] != best_move) {
         move_order->killers[ply][color][1] = move_order->killers[ply][color][0];
@@ -41,19 +179,57 @@ void save_beta_cutoff_data(MOVE_ORDER *move_order, int color, int ply, MOVE best
     // Update bad history for all other quiet moves. Searched but didn't cause a cutoff
     MOVE bad_move = prev_move(ml); // discard last move which is the best move
     while ((bad_move = prev_move(ml)) != MOVE_NONE) {
-        move_order->search_count[color][unpack_piece(bad_move)][unpack_to(bad_move)] += 1;
+        mvpc = unpack_piece(bad_move);
+        tosq = unpack_to(bad_move);
+        HISTORY_INC(move_order, history->search_count[color][mvpc][tosq]);
+        for (int p = 0; p < CONT_PLIES; p++) {
+            if (cont[p] == MOVE_NONE) continue;
+            int pcpc = unpack_piece(cont[p]);
+            int pcsq = unpack_to(cont[p]);
+            cont_history_inc(move_order, &cont_history->search_count[p][color][pcpc][pcsq][mvpc][tosq],
+                &cont_history->cutoff_count[p][color][pcpc][pcsq][mvpc][tosq], FALSE);
+        }
     }
 
     // Save counter move data
     int prev_color = flip_color(color);
     int prev_piece = unpack_piece(previous_move);
     int prev_tosq = unpack_to(previous_move);
-    if (move_order->counter_move[prev_color][prev_piece][prev_tosq][0] != best_move) {
-        move_order->counter_move[prev_color][prev_piece][prev_tosq][1] = move_order->counter_move[prev_color][prev_piece][prev_tosq][0];
-        move_order->counter_move[prev_color][prev_piece][prev_tosq][0] = best_move;
+    MOVE *counter_move = history->counter_move[prev_color][prev_piece][prev_tosq];
+    if (ATOMIC_LOAD(&counter_move[0]) != best_move) {
+        ATOMIC_STORE(&counter_move[1], ATOMIC_LOAD(&counter_move[0]));
+        ATOMIC_STORE(&counter_move[0], best_move);
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Update capture history for a capture searched, and if it caused a beta cutoff.
+//-------------------------------------------------------------------------------------------------
+void save_capture_data(MOVE_ORDER *move_order, int color, MOVE move, int cutoff)
+{
+    HISTORY_TABLE *history = move_order->history;
+
+    int mvpc = unpack_piece(move);
+    int tosq = unpack_to(move);
+    int capt = unpack_capture(move);
+
+    HISTORY_INC(move_order, history->capture_search_count[color][mvpc][tosq][capt]);
+    if (cutoff) HISTORY_INC(move_order, history->capture_cutoff_count[color][mvpc][tosq][capt]);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Move made some plies before current position. Null moves are ignored.
+//-------------------------------------------------------------------------------------------------
+MOVE cont_move(BOARD *board, int plies)
+{
+    if (get_history_ply(board) < plies) return MOVE_NONE;
+
+    MOVE move = board->history[get_history_ply(board) - plies].move;
+    if (unpack_type(move) == MT_NULL) return MOVE_NONE;
+
+    return move;
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Indicate if move is in the "killer moves" list.
 //-------------------------------------------------------------------------------------------------
@@ -69,49 +245,89 @@ int is_counter_move(MOVE_ORDER *move_order, int prev_color, MOVE previous_move,
 {
     int prev_piece = unpack_piece(previous_move);
     int prev_tosq = unpack_to(previous_move);
-    if (move_order->counter_move[prev_color][prev_piece][prev_tosq][0] == current_move) return TRUE;
-    if (move_order->counter_move[prev_color][prev_piece][prev_tosq][1] == current_move) return TRUE;
+    MOVE *counter_move = move_order->history->counter_move[prev_color][prev_piece][prev_tosq];
+    if (ATOMIC_LOAD(&counter_move[0]) == current_move) return TRUE;
+    if (ATOMIC_LOAD(&counter_move[1]) == current_move) return TRUE;
     return FALSE;
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Pruning margin value based on cutoff percentage
+//  Beta cutoff percentage of a move, averaged with double weight for the move itself and single
+//  weight for the continuation after each previous move. Returns "none" if move was not searched
+//  yet.
 //-------------------------------------------------------------------------------------------------
-int get_pruning_margin(MOVE_ORDER *move_order, int color, MOVE move)
+int cutoff_percent(MOVE_ORDER *move_order, BOARD *board, MOVE move, int none)
 {
+    HISTORY_TABLE *history = move_order->history;
+    CONT_HISTORY *cont_history = move_order->cont_history;
+
+    int color = side_on_move(board);
     int mvpc = unpack_piece(move);
     int tosq = unpack_to(move);
+    int total = 0;
+    int weight = 0;
 
-    // if move was not searched yet, we assume a margin to avoid an early pruning.
-    if (move_order->search_count[color][mvpc][tosq] == 0) return 100;
+    int search_count = ATOMIC_LOAD(&history->search_count[color][mvpc][tosq]);
+    if (search_count != 0) {
+        total += 2 * (ATOMIC_LOAD(&history->beta_cutoff_count[color][mvpc][tosq]) * 100 / search_count);
+        weight += 2;
+    }
+
+    for (int p = 0; p < CONT_PLIES; p++) {
+        MOVE prev = cont_move(board, p + 1);
+        if (prev == MOVE_NONE) continue;
+        int (*cont_search)[64] = cont_history->search_count[p][color][unpack_piece(prev)][unpack_to(prev)];
+        int (*cont_cutoff)[64] = cont_history->cutoff_count[p][color][unpack_piece(prev)][unpack_to(prev)];
+        search_count = ATOMIC_LOAD(&cont_search[mvpc][tosq]);
+        if (search_count != 0) {
+            total += ATOMIC_LOAD(&cont_cutoff[mvpc][tosq]) * 100 / search_count;
+            weight++;
+        }
+    }
+
+    if (weight == 0) return none;
 
-    return move_order->beta_cutoff_count[color][mvpc][tosq] * 100 / move_order->search_count[color][mvpc][tosq];
+    return total / weight;
 }
 
 //-------------------------------------------------------------------------------------------------
-//  History value to be used at move ordering.
+//  Pruning margin value based on cutoff percentage
 //-------------------------------------------------------------------------------------------------
-int get_beta_cutoff_percent(MOVE_ORDER *move_order, int color, MOVE move)
+int get_pruning_margin(MOVE_ORDER *move_order, BOARD *board, MOVE move)
 {
-    int mvpc = unpack_piece(move);
-    int tosq = unpack_to(move);
-
-    if (move_order->search_count[color][mvpc][tosq] == 0) return 0;
+    // if move was not searched yet, we assume a margin to avoid an early pruning.
+    return cutoff_percent(move_order, board, move, 100);
+}
 
-    return move_order->beta_cutoff_count[color][mvpc][tosq] * 100 / move_order->search_count[color][mvpc][tosq];
+//-------------------------------------------------------------------------------------------------
+//  History value to be used at move ordering.
+//-------------------------------------------------------------------------------------------------
+int get_beta_cutoff_percent(MOVE_ORDER *move_order, BOARD *board, MOVE move)
+{
+    return cutoff_percent(move_order, board, move, 0);
 }
 
 //-------------------------------------------------------------------------------------------------
 //  Indicate if move had cutoff percentage.
 //-------------------------------------------------------------------------------------------------
-int get_has_bad_history(MOVE_ORDER *move_order, int color, MOVE move)
+int get_has_bad_history(MOVE_ORDER *move_order, BOARD *board, MOVE move)
+{
+    return cutoff_percent(move_order, board, move, 100) < 60 ? TRUE : FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Beta cutoff percentage of a capture. Captures not searched yet are in the middle: 50.
+//-------------------------------------------------------------------------------------------------
+int get_capture_cutoff_percent(MOVE_ORDER *move_order, int color, MOVE move)
 {
     int mvpc = unpack_piece(move);
     int tosq = unpack_to(move);
+    int capt = unpack_capture(move);
+    int search_count = ATOMIC_LOAD(&move_order->history->capture_search_count[color][mvpc][tosq][capt]);
 
-    if (move_order->search_count[color][mvpc][tosq] == 0) return FALSE;
+    if (search_count == 0) return 50;
 
-    return move_order->beta_cutoff_count[color][mvpc][tosq] * 100 / move_order->search_count[color][mvpc][tosq] < 60 ? TRUE : FALSE;
+    return ATOMIC_LOAD(&move_order->history->capture_cutoff_count[color][mvpc][tosq][capt]) * 100 / search_count;
 }
 
 // end
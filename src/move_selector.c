@@ -34,7 +34,7 @@ enum    {TRANS,
 #define    SORT_KILLER     10000000
 #define    SORT_COUNTER     1000000
 
-void    select_next(MOVE_LIST *ml);
+void    sort_moves(MOVE_LIST *ml, int limit);
 int     is_badcap(BOARD *board, MOVE move);
 void    assign_tactical_score(MOVE_LIST *ml);
 void    assign_quiet_score(MOVE_LIST *ml);
@@ -43,6 +43,17 @@ const static int PIECE_VALUE[NUM_PIECES] = {100, 300, 300, 500, 900, 10000};
 const static int VICTIM_VALUE[NUM_PIECES]   = {6, 12, 13, 18, 24, 0};
 const static int ATTACKER_VALUE[NUM_PIECES] = {4,  3,  3,  2,  1, 9};
 
+//  Minimum history score of quiet moves to be sorted by depth. Moves below it are kept in
+//  generation order; killers and counter moves are always sorted.
+#define QUIET_SORT_DEPTH    4
+const static int QUIET_SORT_LIMIT[QUIET_SORT_DEPTH] = {1, 20, 10, 5};
+
+// Statistics, collected only when enabled by select_stats_reset. Each thread counts in its own
+// move ordering data, added to the totals after the search.
+int     select_stats_enabled = FALSE;
+U64     select_stats_lists;
+U64     select_stats_comparisons;
+
 //-------------------------------------------------------------------------------------------------
 //  Preparation for move generation and selection.
 //-------------------------------------------------------------------------------------------------
@@ -56,11 +67,20 @@ void select_init(MOVE_LIST *ml, GAME *game, int incheck, MOVE ttm, int caps)
     ml->late_moves_next = 0;
     ml->ttm = ttm;
     ml->phase = TRANS;
-    ml->sort = TRUE;
+    ml->sort_limit = QUIET_SORT_LIMIT[0];
     ml->board = &game->board;
     ml->move_order = &game->move_order;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Set how many quiet moves are sorted for the search depth. Low depths sort only moves with
+//  good history.
+//-------------------------------------------------------------------------------------------------
+void select_sort_depth(MOVE_LIST *ml, int depth)
+{
+    ml->sort_limit = depth >= QUIET_SORT_DEPTH ? QUIET_SORT_LIMIT[0] : QUIET_SORT_LIMIT[MAX(depth, 0)];
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Add a move to the list
 //-------------------------------------------------------------------------------------------------
@@ -147,14 +167,9 @@ MOVE next_move(MOVE_LIST *ml)
         ml->pins = find_pins(ml->board);
         ml->phase = GEN_CAP;
         if (ml->ttm != MOVE_NONE)  {
-            if (is_valid(ml->board, ml->ttm)) {
-                // Have to make the move in order to test for check legality.
-                // Some moves coming from tt are valid for the position but leave the king in check.
-                make_move(ml->board, ml->ttm);
-                if (is_illegal(ml->board, ml->ttm)) ml->ttm = MOVE_NONE;
-                undo_move(ml->board);
-                if (ml->ttm != MOVE_NONE) return ml->ttm;
-            }
+            // Moves coming from tt may be from another position: test without making the move.
+            if (is_valid(ml->board, ml->ttm) && is_legal(ml->board, ml->pins, ml->incheck, ml->ttm))
+                return ml->ttm;
             ml->ttm = MOVE_NONE;
         }
     case GEN_CAP:
@@ -166,10 +181,10 @@ MOVE next_move(MOVE_LIST *ml)
         ml->count = 0;
         gen_caps(ml->board, ml);
         assign_tactical_score(ml);
+        sort_moves(ml, -MAX_SCORE);
         ml->phase = NEXT_CAP;
     case NEXT_CAP:
         while (ml->next < ml->count) {
-            select_next(ml);
             if (skip_trans_move(ml)) continue;
             if (skip_bad_capture(ml)) continue;
             if (skip_under_promotion(ml)) continue;
@@ -185,13 +200,10 @@ MOVE next_move(MOVE_LIST *ml)
         ml->count = 0;
         gen_moves(ml->board, ml);
         assign_quiet_score(ml);
+        sort_moves(ml, ml->sort_limit);
         ml->phase = NEXT_QUIET;
     case NEXT_QUIET:
         while (ml->next < ml->count) {
-            if (ml->sort) {
-                select_next(ml);
-                ml->sort = ml->score[ml->next];
-            }
             if (skip_trans_move(ml)) continue;
             return ml->moves[ml->next++];
         }
@@ -206,10 +218,10 @@ MOVE next_move(MOVE_LIST *ml)
         ml->next = 0;
         gen_check_evasions(ml->board, ml);
         assign_tactical_score(ml);
+        sort_moves(ml, -MAX_SCORE);
         ml->phase = NEXT_EVASION;
     case NEXT_EVASION:
         while (ml->next < ml->count) {
-            select_next(ml);
             if (skip_trans_move(ml)) continue;
             return ml->moves[ml->next++];
         }
@@ -233,32 +245,78 @@ MOVE prev_move(MOVE_LIST *ml)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Put the move with highest score in front of the list to be picked next.
+//  Sort the moves once, by descending score, before they are picked. Partial insertion sort: only
+//  moves with score >= limit are sorted to the front, the others follow in generation order.
 //-------------------------------------------------------------------------------------------------
-void select_next(MOVE_LIST *ml) 
+void sort_moves(MOVE_LIST *ml, int limit)
 {
-    int     i;
-    int     best_index = ml->next;
+    int     sorted = 0;
+    int     comparisons = 0;
+    int     i, j;
     MOVE    temp_move;
     int     temp_score;
 
-    for (i = ml->next + 1; i < ml->count; i++)  {
-        if (ml->score[i] > ml->score[best_index]) 
-            best_index = i;
+    for (i = 0; i < ml->count; i++) {
+        comparisons++;
+        if (ml->score[i] < limit) continue;
+
+        temp_move = ml->moves[i];
+        temp_score = ml->score[i];
+        ml->moves[i] = ml->moves[sorted];
+        ml->score[i] = ml->score[sorted];
+
+        for (j = sorted++; j > 0 && ml->score[j - 1] < temp_score; j--) {
+            comparisons++;
+            ml->moves[j] = ml->moves[j - 1];
+            ml->score[j] = ml->score[j - 1];
+        }
+        if (j > 0) comparisons++;
+        ml->moves[j] = temp_move;
+        ml->score[j] = temp_score;
     }
-    if (best_index != ml->next) {
-        temp_move = ml->moves[ml->next];
-        ml->moves[ml->next] = ml->moves[best_index];
-        ml->moves[best_index] = temp_move;
-
-        temp_score = ml->score[ml->next];
-        ml->score[ml->next] = ml->score[best_index];
-        ml->score[best_index] = temp_score;
+
+    if (select_stats_enabled) {
+        ml->move_order->sort_lists++;
+        ml->move_order->sort_comparisons += comparisons;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Assign a score value to each tatical move to be used for sorting.
+//  Reset and enable statistics collection.
+//-------------------------------------------------------------------------------------------------
+void select_stats_reset(int enable)
+{
+    select_stats_lists = 0;
+    select_stats_comparisons = 0;
+    select_stats_enabled = enable;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print score comparisons made to sort move lists.
+//-------------------------------------------------------------------------------------------------
+void select_stats_print(U64 nodes)
+{
+    printf("Move ordering: nodes: %" PRIu64 "  sorted lists: %" PRIu64 "  comparisons: %" PRIu64 "  per node: %3.2f  per list: %3.2f\n",
+        nodes, select_stats_lists, select_stats_comparisons,
+        nodes ? (double)select_stats_comparisons / nodes : 0.0,
+        select_stats_lists ? (double)select_stats_comparisons / select_stats_lists : 0.0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Add the statistics counted by one thread to the totals. Called after the search, with the
+//  threads idle.
+//-------------------------------------------------------------------------------------------------
+void select_stats_collect(MOVE_ORDER *mo)
+{
+    select_stats_lists += mo->sort_lists;
+    select_stats_comparisons += mo->sort_comparisons;
+    mo->sort_lists = 0;
+    mo->sort_comparisons = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Assign a score value to each tatical move to be used for sorting. Captures by MVV/LVA, and
+//  capture history between captures with same victim and attacker values.
 //-------------------------------------------------------------------------------------------------
 void assign_tactical_score(MOVE_LIST *ml)
 {
@@ -267,19 +325,21 @@ void assign_tactical_score(MOVE_LIST *ml)
     for (i = 0; i < ml->count; i++) {
         switch (unpack_type(ml->moves[i])) {
         case MT_CAPPC:
-            ml->score[i] = SORT_CAPTURE + VICTIM_VALUE[unpack_capture(ml->moves[i])] + ATTACKER_VALUE[unpack_piece(ml->moves[i])];
+            ml->score[i] = SORT_CAPTURE + (VICTIM_VALUE[unpack_capture(ml->moves[i])] + ATTACKER_VALUE[unpack_piece(ml->moves[i])]) * 10
+                         + get_capture_cutoff_percent(ml->move_order, side_on_move(ml->board), ml->moves[i]) / 10;
             break;
         case MT_EPCAP:
-            ml->score[i] = SORT_CAPTURE + VICTIM_VALUE[PAWN] + ATTACKER_VALUE[PAWN];
+            ml->score[i] = SORT_CAPTURE + (VICTIM_VALUE[PAWN] + ATTACKER_VALUE[PAWN]) * 10
+                         + get_capture_cutoff_percent(ml->move_order, side_on_move(ml->board), ml->moves[i]) / 10;
             break;
         case MT_PROMO:
-            ml->score[i] = SORT_CAPTURE + VICTIM_VALUE[unpack_prom_piece(ml->moves[i])];
+            ml->score[i] = SORT_CAPTURE + VICTIM_VALUE[unpack_prom_piece(ml->moves[i])] * 10;
             break;
         case MT_CPPRM:
-            ml->score[i] = SORT_CAPTURE + VICTIM_VALUE[unpack_prom_piece(ml->moves[i])] + VICTIM_VALUE[unpack_capture(ml->moves[i])];
+            ml->score[i] = SORT_CAPTURE + (VICTIM_VALUE[unpack_prom_piece(ml->moves[i])] + VICTIM_VALUE[unpack_capture(ml->moves[i])]) * 10;
             break;
         default:
-            ml->score[i] = get_beta_cutoff_percent(ml->move_order, side_on_move(ml->board), ml->moves[i]);
+            ml->score[i] = get_beta_cutoff_percent(ml->move_order, ml->board, ml->moves[i]);
             if (is_killer(ml->move_order, side_on_move(ml->board), get_ply(ml->board), ml->moves[i])) {
                 ml->score[i] += SORT_KILLER;
             }
@@ -298,7 +358,7 @@ void assign_quiet_score(MOVE_LIST *ml)
     int     i;
 
     for (i = 0; i < ml->count; i++) {
-        ml->score[i] = get_beta_cutoff_percent(ml->move_order, side_on_move(ml->board), ml->moves[i]);
+        ml->score[i] = get_beta_cutoff_percent(ml->move_order, ml->board, ml->moves[i]);
         if (is_killer(ml->move_order, side_on_move(ml->board), get_ply(ml->board), ml->moves[i])) {
             ml->score[i] += SORT_CAPTURE;
         }
@@ -324,80 +384,124 @@ int is_badcap(BOARD *board, MOVE move)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Verify if move still valid for current position. Usually moves from transposition table.
+//  Verify if move is pseudo legal for current position. Usually moves from transposition table,
+//  that may come from a different position. Checks every field of the move, so any value can be
+//  tested: the move is rebuilt from its squares and has to match the one given.
 //-------------------------------------------------------------------------------------------------
 int is_valid(BOARD *board, MOVE move)
 {
-    static int promo_rank_to[2] = {RANK8, RANK1};
-    static int is_slider[NUM_PIECES] = {0, 0, 1, 1, 1, 0};
-
-    int moving_piece = unpack_piece(move);
-    int from_square = unpack_from(move);
-    int to_square = unpack_to(move);
-    int turn = side_on_move(board);
-
-    assert(from_square != to_square);
+    static const int promo_rank_to[2] = {RANK8, RANK1};
+    static const int pawn_rank_from[2] = {RANK2, RANK7};
+    static const int pawn_step[2] = {-8, 8};
+
+    int     moving_piece = unpack_piece(move);
+    int     captured_piece = unpack_capture(move);
+    int     prom_piece = unpack_prom_piece(move);
+    int     from_square = unpack_from(move);
+    int     to_square = unpack_to(move);
+    int     type = unpack_type(move);
+    int     turn = side_on_move(board);
+    U64     occup = occupied_bb(board);
+    U64     moves = 0;
+    MOVE    same;
+
+    if (type >= MT_NULL || from_square == to_square) return FALSE;
 
     //  moving piece is not on square
-    if (moving_piece != piece_on_square(board, turn, from_square)) return FALSE;
+    if (moving_piece > KING || moving_piece != piece_on_square(board, turn, from_square)) return FALSE;
 
-    //  pawn should be moving forward
-    if (moving_piece == PAWN) {
-        if (turn == WHITE) {
-            if (get_rank(from_square) < get_rank(to_square)) return FALSE;
+    //  piece geometry
+    switch (moving_piece) {
+    case PAWN:
+        if (type == MT_QUIET || type == MT_PROMO) {
+            if (to_square != from_square + pawn_step[turn]) return FALSE;
+        }
+        else if (type == MT_PAWN2) {
+            if (to_square != from_square + 2 * pawn_step[turn]) return FALSE;
+            if (get_rank(from_square) != pawn_rank_from[turn]) return FALSE;
+            if (bb_is_one(occup, from_square + pawn_step[turn])) return FALSE;
+        }
+        else if (type == MT_CAPPC || type == MT_CPPRM || type == MT_EPCAP) {
+            if (!bb_is_one(pawn_attack_bb(turn, to_square), from_square)) return FALSE;
         }
         else {
-            if (get_rank(from_square) > get_rank(to_square)) return FALSE;
+            return FALSE;
         }
+        //  promotion only on last rank
+        if ((get_rank(to_square) == promo_rank_to[turn]) != (type == MT_PROMO || type == MT_CPPRM)) return FALSE;
+        break;
+    case KNIGHT:
+        moves = knight_moves_bb(from_square);
+        break;
+    case BISHOP:
+        moves = bb_bishop_attacks(from_square, occup);
+        break;
+    case ROOK:
+        moves = bb_rook_attacks(from_square, occup);
+        break;
+    case QUEEN:
+        moves = bb_rook_attacks(from_square, occup) | bb_bishop_attacks(from_square, occup);
+        break;
+    case KING:
+        moves = king_moves_bb(from_square);
+        break;
+    }
+    if (moving_piece != PAWN && !move_is_castle(move)) {
+        if (!bb_is_one(moves, to_square)) return FALSE;
+        if (type != MT_QUIET && type != MT_CAPPC) return FALSE;
     }
 
     //  Specific type validation
-    switch (unpack_type(move))  {
+    switch (type) {
     case MT_QUIET:
-        if (bb_is_one(occupied_bb(board), to_square)) return FALSE;
-        if (is_slider[piece_on_square(board, turn, from_square)]) {
-            if (from_to_path_bb(from_square, to_square) & occupied_bb(board)) return FALSE;
-        }
+        if (bb_is_one(occup, to_square)) return FALSE;
+        same = pack_quiet(moving_piece, from_square, to_square);
         break;
     case MT_CAPPC:
-        if (piece_on_square(board, flip_color(turn), to_square) != unpack_capture(move)) {
-            return FALSE;
-        }
-        if (is_slider[piece_on_square(board, turn, from_square)]) {
-            if (from_to_path_bb(from_square, to_square) & occupied_bb(board)) return FALSE;
-        }
+        if (captured_piece > QUEEN || piece_on_square(board, flip_color(turn), to_square) != captured_piece) return FALSE;
+        same = pack_capture(moving_piece, captured_piece, from_square, to_square);
         break;
     case MT_EPCAP:
-        if (to_square != ep_square(board)) return FALSE;
-        if (piece_on_square(board, flip_color(turn), unpack_ep_pawn_square(move)) != PAWN) return FALSE;
+        if (ep_square(board) == 0 || to_square != ep_square(board)) return FALSE;
+        if (piece_on_square(board, flip_color(turn), to_square - pawn_step[turn]) != PAWN) return FALSE;
+        same = pack_en_passant_capture(from_square, to_square, to_square - pawn_step[turn]);
         break;
     case MT_PAWN2:
-        if (bb_is_one(occupied_bb(board), to_square)) return FALSE;
-        if (from_to_path_bb(from_square, to_square) & occupied_bb(board)) return FALSE;
+        if (bb_is_one(occup, to_square)) return FALSE;
+        same = pack_pawn_2square(from_square, to_square, from_square + pawn_step[turn]);
         break;
     case MT_PROMO:
-        if (bb_is_one(occupied_bb(board), to_square)) return FALSE;
-        if (get_rank(to_square) != promo_rank_to[turn]) return FALSE;
-        return TRUE;
+        if (bb_is_one(occup, to_square)) return FALSE;
+        if (prom_piece < KNIGHT || prom_piece > QUEEN) return FALSE;
+        same = pack_promotion(from_square, to_square, prom_piece);
+        break;
     case MT_CPPRM:
-        if (piece_on_square(board, flip_color(turn), to_square) != unpack_capture(move)) return FALSE;
-        if (get_rank(to_square) != promo_rank_to[turn]) return FALSE;
+        if (captured_piece > QUEEN || piece_on_square(board, flip_color(turn), to_square) != captured_piece) return FALSE;
+        if (prom_piece < KNIGHT || prom_piece > QUEEN) return FALSE;
+        same = pack_capture_promotion(captured_piece, from_square, to_square, prom_piece);
         break;
     case MT_CSWKS:
-        if (!can_generate_castle_ks(board, turn)) return FALSE;
+        if (turn != WHITE || from_square != E1 || to_square != G1 || !can_generate_castle_ks(board, WHITE)) return FALSE;
+        same = pack_castle(from_square, to_square, type);
         break;
     case MT_CSWQS:
-        if (!can_generate_castle_qs(board, turn)) return FALSE;
+        if (turn != WHITE || from_square != E1 || to_square != C1 || !can_generate_castle_qs(board, WHITE)) return FALSE;
+        same = pack_castle(from_square, to_square, type);
         break;
     case MT_CSBKS:
-        if (!can_generate_castle_ks(board, turn)) return FALSE;
+        if (turn != BLACK || from_square != E8 || to_square != G8 || !can_generate_castle_ks(board, BLACK)) return FALSE;
+        same = pack_castle(from_square, to_square, type);
         break;
     case MT_CSBQS:
-        if (!can_generate_castle_qs(board, turn)) return FALSE;
+        if (turn != BLACK || from_square != E8 || to_square != C8 || !can_generate_castle_qs(board, BLACK)) return FALSE;
+        same = pack_castle(from_square, to_square, type);
         break;
+    default:
+        return FALSE;
     }
 
-    return TRUE;
+    //  unused bits must be clear
+    return move == same;
 }
 
 //END
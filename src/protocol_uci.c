@@ -26,13 +26,25 @@ char    go_line[MAX_READ];
 int     uci_is_pondering = FALSE;
 int     uci_is_infinite = FALSE;
 
+//  Go thread waits on this event for ponderhit or stop when the search finishes early.
+MUTEX   uci_lock;
+COND    uci_event;
+
 void execute_uci_go(char *line);
 void parse_uci_position(char *line);
 void remove_line_feed_chars(char *line);
+void uci_wait_stop(void);
+void uci_stop_waiting(int stop_search);
 
 #define HASH_OPTION_STRING "setoption name Hash value "
 #define THREADS_OPTION_STRING "setoption name Threads value "
 #define SYZYGY_OPTION_STRING "setoption name SyzygyPath value "
+#define CLEAR_HASH_OPTION_STRING "setoption name ClearHashOnNewGame value "
+#define SHARED_HISTORY_OPTION_STRING "setoption name SharedHistory value "
+#define MULTIPV_OPTION_STRING "setoption name MultiPV value "
+#define EVAL_FILE_OPTION_STRING "setoption name EvalFile value "
+#define EVAL_CACHE_OPTION_STRING "setoption name EvalCache value "
+#define PAWN_CACHE_OPTION_STRING "setoption name PawnCache value "
 
 //-------------------------------------------------------------------------------------------------
 //    UCI main loop.
@@ -41,6 +53,9 @@ void uci_loop(char *engine_name, char *engine_version, char *engine_author) {
 
     THREAD_ID   go_thread = NULL;
 
+    MUTEX_INIT(uci_lock);
+    COND_INIT(uci_event);
+
     // UCI initialization
     printf("id name %s %s\n", engine_name, engine_version);
     printf("id author %s\n", engine_author);
@@ -48,6 +63,15 @@ void uci_loop(char *engine_name, char *engine_version, char *engine_author) {
     printf("option name Threads type spin default 1 min %d max %d\n", MIN_THREADS, MAX_THREADS);
     printf("option name SyzygyPath type string default <empty>\n");
     printf("option name Ponder type check default false\n");
+    printf("option name ClearHashOnNewGame type check default true\n");
+    printf("option name SharedHistory type check default false\n");
+    printf("option name MultiPV type spin default 1 min 1 max %d\n", MAX_MULTIPV);
+    printf("option name EvalFile type string default <empty>\n");
+    printf("option name EvalCache type spin default %d min %d max %d\n", DEFAULT_EVAL_CACHE, MIN_EVAL_CACHE, MAX_EVAL_CACHE);
+    printf("option name PawnCache type spin default %d min %d max %d\n", DEFAULT_PAWN_CACHE, MIN_EVAL_CACHE, MAX_EVAL_CACHE);
+#ifdef TUNE_OPTIONS
+    search_param_uci_options();
+#endif
     printf("uciok\n");
     
     while (TRUE) {
@@ -59,10 +83,16 @@ void uci_loop(char *engine_name, char *engine_version, char *engine_author) {
         remove_line_feed_chars(uci_line);
 
         if (!strcmp(uci_line, "isready")) {
+            if (tt_clear_wait()) tt_print_info("info string ");
             printf("readyok\n");
             continue;
         }
 
+        if (!strcmp(uci_line, "smpstats")) {
+            smp_stats_print("info string ", TRUE, 0);
+            continue;
+        }
+
         if (!strcmp(uci_line, "ucinewgame")) {
             new_game(&main_game, FEN_NEW_GAME);
             continue;
@@ -84,6 +114,64 @@ void uci_loop(char *engine_name, char *engine_version, char *engine_author) {
             continue;
         }
 
+        if (!strncmp(uci_line, CLEAR_HASH_OPTION_STRING, strlen(CLEAR_HASH_OPTION_STRING))) {
+            int clear = strcmp(&uci_line[strlen(CLEAR_HASH_OPTION_STRING)], "false") ? TRUE : FALSE;
+            tt_set_clear_new_game(clear);
+            printf("info string ClearHashOnNewGame set to %s\n", clear ? "true" : "false");
+            continue;
+        }
+
+        if (!strncmp(uci_line, MULTIPV_OPTION_STRING, strlen(MULTIPV_OPTION_STRING))) {
+            int lines = atoi(&uci_line[strlen(MULTIPV_OPTION_STRING)]);
+            lines = MAX(1, MIN(lines, MAX_MULTIPV));
+            set_multipv(lines);
+            printf("info string MultiPV set to %d\n", lines);
+            continue;
+        }
+
+        if (!strncmp(uci_line, SHARED_HISTORY_OPTION_STRING, strlen(SHARED_HISTORY_OPTION_STRING))) {
+            int shared = strcmp(&uci_line[strlen(SHARED_HISTORY_OPTION_STRING)], "true") ? FALSE : TRUE;
+            set_shared_history(shared);
+            printf("info string SharedHistory set to %s\n", shared ? "true" : "false");
+            continue;
+        }
+
+        if (!strncmp(uci_line, EVAL_CACHE_OPTION_STRING, strlen(EVAL_CACHE_OPTION_STRING))) {
+            int size_kb = eval_cache_set_size(atoi(&uci_line[strlen(EVAL_CACHE_OPTION_STRING)]));
+            threads_eval_cache_alloc();
+            printf("info string EvalCache set to %d KB\n", size_kb);
+            continue;
+        }
+
+        if (!strncmp(uci_line, PAWN_CACHE_OPTION_STRING, strlen(PAWN_CACHE_OPTION_STRING))) {
+            int size_kb = pawn_cache_set_size(atoi(&uci_line[strlen(PAWN_CACHE_OPTION_STRING)]));
+            threads_eval_cache_alloc();
+            printf("info string PawnCache set to %d KB\n", size_kb);
+            continue;
+        }
+
+        if (!strncmp(uci_line, EVAL_FILE_OPTION_STRING, strlen(EVAL_FILE_OPTION_STRING))) {
+            char *eval_file = &uci_line[strlen(EVAL_FILE_OPTION_STRING)];
+            threads_clear_eval_table();
+            if (nnue_load(eval_file))
+                printf("info string EvalFile set to %s (%s)\n", eval_file, nnue_simd_name());
+            else
+                printf("info string EvalFile not loaded, using classical evaluation\n");
+            continue;
+        }
+
+#ifdef TUNE_OPTIONS
+        //  Search parameters, e.g. for SPSA tuning. Only in builds with -DTUNE_OPTIONS.
+        if (!strncmp(uci_line, "setoption name ", 15)) {
+            char param_name[MAX_READ];
+            int param_value;
+            if (sscanf(uci_line, "setoption name %s value %d", param_name, &param_value) == 2 && search_param_set(param_name, param_value)) {
+                printf("info string %s set to %d\n", param_name, param_value);
+                continue;
+            }
+        }
+#endif
+
 #ifdef EGTB_SYZYGY
         if (!strncmp(uci_line, SYZYGY_OPTION_STRING, strlen(SYZYGY_OPTION_STRING))) {
             char *syzygy_path = &uci_line[strlen(SYZYGY_OPTION_STRING)];
@@ -108,14 +196,12 @@ void uci_loop(char *engine_name, char *engine_version, char *engine_author) {
         }
 
         if (!strcmp(uci_line, "ponderhit")) {
-            uci_is_pondering = FALSE; // stop pondering but search can continue
+            uci_stop_waiting(FALSE); // stop pondering but search can continue
             continue;
         }
 
         if (!strcmp(uci_line, "stop")) {
-            main_game.search.abort = TRUE;
-            uci_is_infinite = FALSE;
-            uci_is_pondering = FALSE;
+            uci_stop_waiting(TRUE);
             THREAD_WAIT(go_thread);
             continue;
         }
@@ -149,11 +235,32 @@ void execute_uci_go(char *line)
     int moves_to_go = -1;
     int wtime = -1;
     int btime = -1;
+    int winc = 0;
+    int binc = 0;
     int move_time = -1;
+    U64 nodes = 0;
+    int mate = 0;
+    int search_moves = FALSE;
+
+    game_settings.search_moves_count = 0;
 
     char *token = strtok(line, " "); // skip "go "
 
     for (token = strtok(NULL, " "); token != NULL; token = strtok(NULL, " ")) {
+        // search moves list ends at the next keyword
+        if (search_moves) {
+            MOVE move = util_parse_move(&main_game, token);
+            if (move != MOVE_NONE) {
+                if (game_settings.search_moves_count < MAX_ROOT_MOVES)
+                    game_settings.search_moves[game_settings.search_moves_count++] = move;
+                continue;
+            }
+            search_moves = FALSE;
+        }
+        if (!strcmp(token, "searchmoves")) {
+            search_moves = TRUE;
+            continue;
+        }
         if (!strcmp(token, "wtime")) {
             wtime = atoi(strtok(NULL, " "));
             continue;
@@ -162,10 +269,26 @@ void execute_uci_go(char *line)
             btime = atoi(strtok(NULL, " "));
             continue;
         }
+        if (!strcmp(token, "winc")) {
+            winc = atoi(strtok(NULL, " "));
+            continue;
+        }
+        if (!strcmp(token, "binc")) {
+            binc = atoi(strtok(NULL, " "));
+            continue;
+        }
         if (!strcmp(token, "depth")) {
             depth = atoi(strtok(NULL, " "));
             continue;
         }
+        if (!strcmp(token, "nodes")) {
+            nodes = strtoull(strtok(NULL, " "), NULL, 10);
+            continue;
+        }
+        if (!strcmp(token, "mate")) {
+            mate = atoi(strtok(NULL, " "));
+            continue;
+        }
         if (!strcmp(token, "infinite")) {
             infinite = TRUE;
             continue;
@@ -190,25 +313,33 @@ void execute_uci_go(char *line)
     game_settings.single_move_time = 0;
     game_settings.total_move_time = 0;
     game_settings.moves_to_go = 0;
+    game_settings.increment = 0;
+    game_settings.max_nodes = nodes;
+    game_settings.mate_in = MAX(0, mate);
 
     int time = side_on_move(&main_game.board) == WHITE ? wtime : btime;
+    int increment = side_on_move(&main_game.board) == WHITE ? winc : binc;
 
     if (depth != -1) game_settings.max_depth = MAX(1, MIN(depth, MAX_DEPTH));
     if (time != -1) game_settings.total_move_time = time;
+    if (increment > 0) game_settings.increment = increment;
     if (move_time != -1) game_settings.single_move_time = move_time;
     if (moves_to_go != -1) game_settings.moves_to_go = moves_to_go;
+    // no limits at all: same as go infinite
+    if (time == -1 && move_time == -1 && depth == -1 && nodes == 0 && mate == 0) infinite = TRUE;
+    MUTEX_LOCK(uci_lock);
     if (ponder) uci_is_pondering = TRUE;
     if (infinite) uci_is_infinite = TRUE;
+    MUTEX_UNLOCK(uci_lock);
     if (uci_is_infinite) game_settings.single_move_time = MAX_TIME;
+    // depth, nodes or mate without time control: search until the limit is reached
+    if (time == -1 && move_time == -1 && (depth != -1 || nodes != 0 || mate != 0)) game_settings.single_move_time = MAX_TIME;
 
     // search
     search_run(&main_game, &game_settings);
 
-    // Ponder: if search finish early have to wait for stop or ponderhit commands from uci
-    while (uci_is_pondering);
-
-    // Infinite: if search finish early have to wait for stop command from uci
-    if (uci_is_infinite) while (!main_game.search.abort);
+    // Ponder or infinite: if search finish early have to wait for stop or ponderhit commands from uci
+    uci_wait_stop();
 
     // print move
     char move_string[10];
@@ -225,6 +356,33 @@ void execute_uci_go(char *line)
     fflush(stdout);
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Wait without using cpu until pondering or infinite search is ended by ponderhit or stop.
+//-------------------------------------------------------------------------------------------------
+void uci_wait_stop(void)
+{
+    MUTEX_LOCK(uci_lock);
+    while (uci_is_pondering || uci_is_infinite) {
+        COND_WAIT(uci_event, uci_lock);
+    }
+    MUTEX_UNLOCK(uci_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Handle ponderhit (search continues) and stop (search ends) commands, waking up the go thread.
+//-------------------------------------------------------------------------------------------------
+void uci_stop_waiting(int stop_search)
+{
+    MUTEX_LOCK(uci_lock);
+    if (stop_search) {
+        main_game.search.abort = TRUE;
+        uci_is_infinite = FALSE;
+    }
+    uci_is_pondering = FALSE;
+    COND_BROADCAST(uci_event);
+    MUTEX_UNLOCK(uci_lock);
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Parse UCI "position" command:
 //          position [fen <fenstring> | startpos ]  moves <move1> .... <movei>
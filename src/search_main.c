@@ -25,18 +25,88 @@ U64     cnt = 0;
 U64     hit = 0;
 
 int     search_asp(GAME *game_data, int incheck, int depth, int prev_score);
+int     search_multipv(GAME *game, int incheck, int depth, int lines);
 void    iterative_deepening(GAME *game_data);
+double  time_factor(GAME *game, U64 iteration_nodes, int best_move_stability);
+void    timer_thread(void);
+void    timer_start(GAME *game, U64 deadline);
+void    timer_stop(void);
 
 GAME    *thread_data = NULL;
 int     additional_threads = 0;
+int     multipv_lines = 1;
+
+//  Thread pool: helpers are created once and wait for a search start signal.
+MUTEX   pool_lock;
+COND    pool_start;
+COND    pool_idle;
+int     pool_init = FALSE;
+int     pool_search_id = 0;
+int     pool_active = 0;
+int     pool_exit = FALSE;
+U64     pool_start_time = 0;
+
+//  Timer thread: sets the abort flag of all search threads when the deadline is reached.
+MUTEX   timer_lock;
+COND    timer_event;
+GAME    *timer_game = NULL;
+U64     timer_deadline = 0;
+THREAD_ID timer_thread_id;
+#define TIMER_RETRY     1000000ULL  // nanoseconds between checks while the first iteration runs
+
+//  Wake up and stop latency statistics.
+MUTEX   stats_lock;
+U64     pool_searches = 0;
+U64     pool_wake_total = 0;
+U64     pool_wake_max = 0;
+U64     pool_stop_total = 0;
+U64     pool_stop_max = 0;
+
+//  Per thread statistics. Index 0 is the main thread. Each thread counts in its own GAME and the
+//  totals are collected under stats_lock after the search, so smpstats can run during a search.
+typedef struct s_thread_stats
+{
+    U64     searches;
+    U64     nodes;
+    U64     tt_probes;
+    U64     tt_hits;
+    U64     search_time;    // nanoseconds running search
+    U64     total_time;     // nanoseconds of the whole search (main thread)
+    int     depth;          // completed depth (sum for totals)
+}   THREAD_STATS;
+
+THREAD_STATS    smp_last[MAX_THREADS];
+THREAD_STATS    smp_total[MAX_THREADS];
+
+void    smp_stats_collect(GAME *game, int index, U64 total_time);
+
+//  Depth skip schedule for helper threads: each helper skips a different set of iterations.
+static const int skip_size[20]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int skip_phase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+void    helper_thread(GAME *game);
+void    threads_exit(void);
 
 //-------------------------------------------------------------------------------------------------
-//  Create threads data.
+//  Create threads data and start helper threads. They wait until a search is started.
 //-------------------------------------------------------------------------------------------------
 void threads_init(int threads_count)
 {
-    if (thread_data != NULL) free(thread_data);
+    if (!pool_init) {
+        MUTEX_INIT(pool_lock);
+        MUTEX_INIT(stats_lock);
+        COND_INIT(pool_start);
+        COND_INIT(pool_idle);
+        MUTEX_INIT(timer_lock);
+        util_timed_cond_init(&timer_event);
+        THREAD_CREATE(timer_thread_id, timer_thread, NULL);
+        pool_init = TRUE;
+    }
+
+    threads_exit();
+
     if (threads_count <= 0) threads_count = 1;
+    tt_set_threads(threads_count);
     additional_threads = threads_count - 1;
     if (additional_threads == 0) return;
     thread_data = (GAME *)malloc(sizeof(GAME) * additional_threads);
@@ -46,6 +116,178 @@ void threads_init(int threads_count)
         return;
     }
     memset(thread_data, 0, (size_t)(sizeof(GAME) * additional_threads));
+
+    pool_exit = FALSE;
+    for (int i = 0; i < additional_threads; i++) {
+        thread_data[i].is_main_thread = FALSE;
+        thread_data[i].thread_number = i;
+        thread_data[i].search_id = pool_search_id;
+        move_order_alloc(&thread_data[i].move_order);
+        eval_cache_alloc(&thread_data[i]);
+        THREAD_CREATE(thread_data[i].thread_handle, helper_thread, &thread_data[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Reallocate eval caches of main game and helper threads after a size change. Threads are idle.
+//-------------------------------------------------------------------------------------------------
+void threads_eval_cache_alloc(void)
+{
+    eval_cache_alloc(&main_game);
+    for (int i = 0; i < additional_threads; i++) {
+        eval_cache_alloc(&thread_data[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear move ordering data of helper threads and the shared history for a new game. Threads are
+//  idle.
+//-------------------------------------------------------------------------------------------------
+void threads_clear_move_order(void)
+{
+    clear_shared_history();
+    for (int i = 0; i < additional_threads; i++) {
+        clear_move_order(&thread_data[i].move_order);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear eval caches of main game and helper threads, after the evaluation changed. Threads are
+//  idle.
+//-------------------------------------------------------------------------------------------------
+void threads_clear_eval_table(void)
+{
+    clear_eval_table(&main_game);
+    for (int i = 0; i < additional_threads; i++) {
+        clear_eval_table(&thread_data[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Terminate helper threads and release their data.
+//-------------------------------------------------------------------------------------------------
+void threads_exit(void)
+{
+    if (thread_data == NULL) return;
+
+    MUTEX_LOCK(pool_lock);
+    pool_exit = TRUE;
+    COND_BROADCAST(pool_start);
+    MUTEX_UNLOCK(pool_lock);
+
+    for (int i = 0; i < additional_threads; i++) {
+        THREAD_WAIT(thread_data[i].thread_handle);
+        eval_cache_free(&thread_data[i]);
+        move_order_free(&thread_data[i].move_order);
+    }
+
+    free(thread_data);
+    thread_data = NULL;
+    additional_threads = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Helper thread: wait for a new search, run it and notify when finished.
+//-------------------------------------------------------------------------------------------------
+void helper_thread(GAME *game)
+{
+    MUTEX_LOCK(pool_lock);
+
+    while (TRUE) {
+        while (game->search_id == pool_search_id && !pool_exit) {
+            COND_WAIT(pool_start, pool_lock);
+        }
+        if (pool_exit) break;
+        game->search_id = pool_search_id;
+        game->wake_latency = util_get_time_ns() - pool_start_time;
+        MUTEX_UNLOCK(pool_lock);
+
+        U64 start_time = util_get_time_ns();
+        iterative_deepening(game);
+        game->search_time = util_get_time_ns() - start_time;
+
+        MUTEX_LOCK(pool_lock);
+        if (--pool_active == 0) COND_SIGNAL(pool_idle);
+    }
+
+    MUTEX_UNLOCK(pool_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Timer thread: sleep until the deadline of the running search and then stop all threads. The
+//  first iteration always completes, so there is a searched move to play.
+//-------------------------------------------------------------------------------------------------
+void timer_thread(void)
+{
+    MUTEX_LOCK(timer_lock);
+
+    while (TRUE) {
+        if (timer_game == NULL) {
+            COND_WAIT(timer_event, timer_lock);
+            continue;
+        }
+        U64 current_time = util_get_time_ns();
+        if (current_time >= timer_deadline && ATOMIC_LOAD(&timer_game->search.completed_depth) == 0) {
+            util_timed_cond_wait(&timer_event, &timer_lock, TIMER_RETRY);
+            continue;
+        }
+        if (current_time >= timer_deadline) {
+            timer_game->search.abort = TRUE;
+            for (int i = 0; i < additional_threads; i++) {
+                thread_data[i].search.abort = TRUE;
+            }
+            timer_game = NULL;
+            continue;
+        }
+        util_timed_cond_wait(&timer_event, &timer_lock, timer_deadline - current_time);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Set the deadline (monotonic nanoseconds) for the search of this game.
+//-------------------------------------------------------------------------------------------------
+void timer_start(GAME *game, U64 deadline)
+{
+    MUTEX_LOCK(timer_lock);
+    timer_game = game;
+    timer_deadline = deadline;
+    COND_SIGNAL(timer_event);
+    MUTEX_UNLOCK(timer_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Cancel the deadline. After return the timer will not change abort flags.
+//-------------------------------------------------------------------------------------------------
+void timer_stop(void)
+{
+    MUTEX_LOCK(timer_lock);
+    timer_game = NULL;
+    MUTEX_UNLOCK(timer_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Reset latency statistics.
+//-------------------------------------------------------------------------------------------------
+void threads_stats_reset(void)
+{
+    MUTEX_LOCK(stats_lock);
+    pool_searches = pool_wake_total = pool_wake_max = pool_stop_total = pool_stop_max = 0;
+    MUTEX_UNLOCK(stats_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print latency statistics: time for all helpers to start searching after search start, and
+//  time for all helpers to finish after the main thread stopped.
+//-------------------------------------------------------------------------------------------------
+void threads_stats_print(void)
+{
+    MUTEX_LOCK(stats_lock);
+    if (additional_threads > 0 && pool_searches > 0) {
+        printf("Threads: %d  wake latency: avg %3.1f us, max %3.1f us  stop latency: avg %3.1f us, max %3.1f us\n", additional_threads + 1,
+            (double)pool_wake_total / pool_searches / 1000.0, (double)pool_wake_max / 1000.0,
+            (double)pool_stop_total / pool_searches / 1000.0, (double)pool_stop_max / 1000.0);
+    }
+    MUTEX_UNLOCK(stats_lock);
 }
 
 void ponder_search(GAME *game)
@@ -58,6 +300,10 @@ void ponder_search(GAME *game)
     ponder_settings.max_depth = MAX_DEPTH;
     ponder_settings.post_flag = POST_XBOARD;
     ponder_settings.use_book = FALSE;
+    ponder_settings.increment = 0;
+    ponder_settings.max_nodes = 0;
+    ponder_settings.mate_in = 0;
+    ponder_settings.search_moves_count = 0;
 
     search_run(game, &ponder_settings);
 }
@@ -67,9 +313,13 @@ void ponder_search(GAME *game)
 //-------------------------------------------------------------------------------------------------
 void search_run(GAME *game, SETTINGS *settings)
 {
+    //  Hash table may be cleared in background
+    tt_clear_wait();
+
     //  Prepare search control
     prepare_search(game, settings);
 
+    U64 start_time_ns = util_get_time_ns();
     game->search.start_time = util_get_time();
     game->search.normal_finish_time = game->search.start_time + game->search.normal_move_time;
     game->search.extended_finish_time = game->search.start_time + game->search.extended_move_time;
@@ -79,6 +329,11 @@ void search_run(GAME *game, SETTINGS *settings)
     game->search.abort = FALSE;
     game->search.nodes = 0;
     game->search.tbhits = 0;
+    game->search.completed_depth = 0;
+    game->search.multipv = multipv_lines;
+    game->search.pv_index = 0;
+    game->search.tt_probes = 0;
+    game->search.tt_hits = 0;
 
     game->is_main_thread = TRUE;
 
@@ -96,31 +351,147 @@ void search_run(GAME *game, SETTINGS *settings)
     // Prepare search data
     set_ply(&game->board, 0);
     memset(&game->pv_line, 0, sizeof(PV_LINE));
-    memset(&game->move_order, 0, sizeof(MOVE_ORDER));
+    init_move_order(&game->move_order);
+    clear_killers(&game->move_order);
     tt_age();
 
-    //  Multi Thread: copy data to additional threads and start them.
+    //  Multi Thread: copy root position to additional threads and wake them up. Their eval
+    //  caches and history tables are kept between searches, only killers are cleared, the same
+    //  as the main thread. All history tables are reset by new_game.
     for (int i = 0; i < additional_threads; i++) {
-        memcpy(&thread_data[i].board, &game->board, sizeof(BOARD));
-		memcpy(&thread_data[i].search, &game->search, sizeof(SEARCH));
-        memcpy(&thread_data[i].move_order, &game->move_order, sizeof(MOVE_ORDER));
-        thread_data[i].is_main_thread = FALSE;
+        copy_board(&thread_data[i].board, &game->board);
+        memcpy(&thread_data[i].search, &game->search, sizeof(SEARCH));
+        init_move_order(&thread_data[i].move_order);
+        clear_killers(&thread_data[i].move_order);
         thread_data[i].search.post_flag = POST_NONE;
-        thread_data[i].thread_number = i;
-        THREAD_CREATE(thread_data[i].thread_handle, iterative_deepening, &thread_data[i]);
+        thread_data[i].search.multipv = 1;
+    }
+    if (additional_threads) {
+        MUTEX_LOCK(pool_lock);
+        pool_active = additional_threads;
+        pool_search_id++;
+        pool_start_time = util_get_time_ns();
+        COND_BROADCAST(pool_start);
+        MUTEX_UNLOCK(pool_lock);
     }
 
-    //  Run main search
+    //  Run main search, timer thread stops all threads at the extended time.
+    timer_start(game, start_time_ns + (U64)game->search.extended_move_time * 1000000ULL);
+    U64 search_start = util_get_time_ns();
     iterative_deepening(game);
+    game->search_time = util_get_time_ns() - search_start;
+    timer_stop();
+
+    //  Notify additional threads to finish and wait until all are idle.
+    if (additional_threads) {
+        U64 stop_time = util_get_time_ns();
+        for (int i = 0; i < additional_threads; i++) {
+            thread_data[i].search.abort = TRUE;
+        }
+        MUTEX_LOCK(pool_lock);
+        while (pool_active > 0) {
+            COND_WAIT(pool_idle, pool_lock);
+        }
+        MUTEX_UNLOCK(pool_lock);
+        stop_time = util_get_time_ns() - stop_time;
 
-	//  Notify additional threads to finish
-    for (int i = 0; i < additional_threads; i++) {
-        thread_data[i].search.abort = TRUE;
-        THREAD_WAIT(thread_data[i].thread_handle);
+        U64 wake_time = 0;
+        for (int i = 0; i < additional_threads; i++) {
+            if (thread_data[i].wake_latency > wake_time) wake_time = thread_data[i].wake_latency;
+        }
+        MUTEX_LOCK(stats_lock);
+        pool_searches++;
+        pool_wake_total += wake_time;
+        pool_stop_total += stop_time;
+        if (wake_time > pool_wake_max) pool_wake_max = wake_time;
+        if (stop_time > pool_stop_max) pool_stop_max = stop_time;
+        MUTEX_UNLOCK(stats_lock);
     }
 
     game->search.end_time = util_get_time();
     game->search.elapsed_time = game->search.end_time - game->search.start_time;
+
+    //  Collect statistics
+    U64 total_time = util_get_time_ns() - search_start;
+    MUTEX_LOCK(stats_lock);
+    smp_stats_collect(game, 0, total_time);
+    select_stats_collect(&game->move_order);
+    for (int i = 0; i < additional_threads; i++) {
+        smp_stats_collect(&thread_data[i], i + 1, total_time);
+        select_stats_collect(&thread_data[i].move_order);
+    }
+    MUTEX_UNLOCK(stats_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Save thread statistics for the last search and add to totals.
+//-------------------------------------------------------------------------------------------------
+void smp_stats_collect(GAME *game, int index, U64 total_time)
+{
+    THREAD_STATS *last = &smp_last[index];
+
+    last->searches = 1;
+    last->nodes = game->search.nodes;
+    last->tt_probes = game->search.tt_probes;
+    last->tt_hits = game->search.tt_hits;
+    last->search_time = MIN(game->search_time, total_time);
+    last->total_time = total_time;
+    last->depth = game->search.completed_depth;
+
+    THREAD_STATS *total = &smp_total[index];
+
+    total->searches += last->searches;
+    total->nodes += last->nodes;
+    total->tt_probes += last->tt_probes;
+    total->tt_hits += last->tt_hits;
+    total->search_time += last->search_time;
+    total->total_time += last->total_time;
+    total->depth += last->depth;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Reset accumulated thread statistics.
+//-------------------------------------------------------------------------------------------------
+void smp_stats_reset(void)
+{
+    MUTEX_LOCK(stats_lock);
+    memset(smp_last, 0, sizeof(smp_last));
+    memset(smp_total, 0, sizeof(smp_total));
+    MUTEX_UNLOCK(stats_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print per thread statistics for the last search or accumulated since last reset.
+//  Wait time is the part of the search a thread was not searching: waking up, finished early or
+//  waiting for the others to stop. Speedup is shown if a single thread nps baseline is given.
+//-------------------------------------------------------------------------------------------------
+void smp_stats_print(char *prefix, int last_search, double baseline_nps)
+{
+    THREAD_STATS    *stats = last_search ? smp_last : smp_total;
+    U64             nodes = 0;
+    double          total_time = 0;
+
+    MUTEX_LOCK(stats_lock);
+    for (int i = 0; i <= additional_threads; i++) {
+        THREAD_STATS *ts = &stats[i];
+        if (ts->searches == 0) continue;
+        double search_ms = (double)ts->search_time / 1000000.0;
+        double wait_ms = (double)(ts->total_time - ts->search_time) / 1000000.0;
+        printf("%sthread %d nodes %" PRIu64 " nps %.0f depth %.1f search %.0f ms wait %.0f ms tthits %.1f%%\n", prefix, i,
+            ts->nodes, search_ms > 0 ? (double)ts->nodes * 1000.0 / search_ms : 0.0,
+            (double)ts->depth / ts->searches, search_ms, wait_ms,
+            ts->tt_probes ? 100.0 * (double)ts->tt_hits / ts->tt_probes : 0.0);
+        nodes += ts->nodes;
+        if (i == 0) total_time = (double)ts->total_time / 1000000000.0;
+    }
+
+    if (total_time > 0) {
+        double nps = (double)nodes / total_time;
+        printf("%sthreads %d nodes %" PRIu64 " nps %.0f", prefix, additional_threads + 1, nodes, nps);
+        if (baseline_nps > 0) printf(" nps speedup %.2f", nps / baseline_nps);
+        printf("\n");
+    }
+    MUTEX_UNLOCK(stats_lock);
 }
 
 U64 get_additional_threads_nodes(void)
@@ -158,31 +529,44 @@ void iterative_deepening(GAME *game)
 
     int incheck = is_incheck(&game->board, side_on_move(&game->board));
 
-    // Count moves at root node (for analyse info)
-    game->search.root_move_count = 0;
-    MOVE_LIST   root;
-    MOVE        move;
+    // Legal moves at root node, also used for analyse info
+    root_moves_init(game);
+    game->search.root_move_count = game->root_moves.count;
 
-    select_init(&root, game, incheck, MOVE_NONE, FALSE);
-    while ((move = next_move(&root)) != MOVE_NONE) {
-        if (is_pseudo_legal(&game->board, root.pins, move))
-            game->search.root_move_count++;
-    }
+    //  Multi PV lines, limited by the number of legal moves
+    int lines = MIN(game->search.multipv, game->search.root_move_count);
+    if (lines < 1) lines = 1;
 
     //  Start the iterative deepening
     int prev_score = 0;
     int var = 0;
+    U64 prev_iteration_nodes = 0;
+    MOVE prev_best_move = MOVE_NONE;
+    int best_move_stability = 0;
     for (int depth = 1; depth <= game->search.max_depth; depth++) {
 
-        if (!game->is_main_thread && depth > 1 && game->thread_number % 2 == 0)
-            if (depth == game->thread_number && depth < game->search.max_depth)
-                depth++;
+        //  Helpers skip some iterations according to its schedule.
+        if (!game->is_main_thread && depth > 1 && depth < game->search.max_depth) {
+            int i = game->thread_number % 20;
+            if (((depth + game->board.histply + skip_phase[i]) / skip_size[i]) % 2)
+                continue;
+        }
 
         game->search.cur_depth = depth;
+        root_moves_new_iteration(game);
+        U64 iteration_start_nodes = game->search.nodes;
+        UINT iteration_start_time = util_get_time();
 
-        int score = search_asp(game, incheck, depth, prev_score);
+        int score = lines > 1 ? search_multipv(game, incheck, depth, lines) : search_asp(game, incheck, depth, prev_score);
         if (game->search.abort) break;
 
+        game->search.completed_depth = depth;
+
+        //  Mate search: stop when a mate in the requested number of moves is found.
+        if (game->search.mate_in && score > 0 && is_mate_score(score) && (MATE_VALUE - score + 1) / 2 <= game->search.mate_in) {
+            break;
+        }
+
         // Verify if score dropped from last iteration.
         if (depth > 4) {
             if (score + 20 < prev_score)
@@ -198,11 +582,21 @@ void iterative_deepening(GAME *game)
             game->search.score_drop = FALSE;
 
         //  Don't start another iteration if most of time was used.
-        UINT used_time = util_get_time() - game->search.start_time;
+        UINT current_time = util_get_time();
+        UINT used_time = current_time - game->search.start_time;
+
+        //  Iterations with the same best move
+        if (game->root_moves.moves[0].move == prev_best_move)
+            best_move_stability++;
+        else
+            best_move_stability = 0;
+        prev_best_move = game->root_moves.moves[0].move;
 
-        // normal termination after completed iteration.
+        U64 iteration_nodes = game->search.nodes - iteration_start_nodes;
+
+        // normal termination after completed iteration, time adjusted by the search behavior.
         if (!game->search.score_drop && depth > 1) {
-            if (used_time >= game->search.normal_move_time) {
+            if (used_time >= game->search.normal_move_time * time_factor(game, iteration_nodes, best_move_stability)) {
                 break;
             }
         }
@@ -212,13 +606,24 @@ void iterative_deepening(GAME *game)
             }
         }
 
+        //  Estimate next iteration time using the effective branching factor.
+        if (depth > 4 && prev_iteration_nodes > 0) {
+            double ebf = MIN((double)iteration_nodes / prev_iteration_nodes, 8.0);
+            UINT next_time = (UINT)((current_time - iteration_start_time) * ebf);
+            if (used_time + next_time >= game->search.extended_move_time) {
+                break;
+            }
+        }
+        prev_iteration_nodes = iteration_nodes;
+
         prev_score = score;
     }
 
     // collect best and ponder moves
     if (game->is_main_thread) {
-        game->search.best_move = game->pv_line.pv_line[0][0];
-        game->search.ponder_move = game->pv_line.pv_line[0][1];
+        ROOT_MOVE *best = &game->root_moves.moves[0];
+        game->search.best_move = game->root_moves.count > 0 ? best->move : game->pv_line.pv_line[0][0];
+        game->search.ponder_move = game->root_moves.count > 0 && best->pv_size > 1 ? best->pv[1] : MOVE_NONE;
     }
 
     // print counters, used for testing.
@@ -230,6 +635,67 @@ void iterative_deepening(GAME *game)
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Scale the normal move time after an iteration. When most nodes were spent on the best move
+//  and it has been stable, other moves were refuted easily and the search can stop earlier.
+//  An unstable best move or a large share of nodes on the other moves gets more time.
+//-------------------------------------------------------------------------------------------------
+double time_factor(GAME *game, U64 iteration_nodes, int best_move_stability)
+{
+    static const double STABILITY_FACTOR[5] = {1.60, 1.20, 1.00, 0.85, 0.75};
+
+    // multi pv spreads the nodes over several lines
+    if (game->search.multipv > 1) return 1.0;
+
+    double best_share = 1.0;
+    if (iteration_nodes > 0)
+        best_share = (double)game->root_moves.moves[0].nodes / iteration_nodes;
+    double nodes_factor = MAX(0.5, 2.0 * (1.0 - best_share) + 0.5);
+
+    return nodes_factor * STABILITY_FACTOR[MIN(best_move_stability, 4)];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Multi PV search: line k searches the root moves from k onward with its own aspiration window,
+//  so the best of the remaining moves ends up at position k. Lines are reported after the
+//  iteration, sorted by score.
+//-------------------------------------------------------------------------------------------------
+int search_multipv(GAME *game, int incheck, int depth, int lines)
+{
+    ROOT_MOVE   *root_move;
+
+    for (int pv_index = 0; pv_index < lines; pv_index++) {
+        game->search.pv_index = pv_index;
+        search_asp(game, incheck, depth, game->root_moves.moves[pv_index].prev_score);
+        if (game->search.abort) break;
+    }
+    game->search.pv_index = 0;
+    if (game->search.abort) return 0;
+
+    //  Sort lines by score
+    root_moves_sort(game, 0, lines);
+
+    //  Best line is the main principal variation
+    root_move = &game->root_moves.moves[0];
+    memcpy(game->pv_line.pv_line[0], root_move->pv, sizeof(MOVE) * root_move->pv_size);
+    game->pv_line.pv_size[0] = root_move->pv_size;
+
+    for (int i = 0; i < lines; i++) {
+        root_move = &game->root_moves.moves[i];
+        post_line(game, root_move->score, depth, root_move->pv, root_move->pv_size, i + 1);
+    }
+
+    return game->root_moves.moves[0].score;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Set number of lines for multi PV search.
+//-------------------------------------------------------------------------------------------------
+void set_multipv(int lines)
+{
+    multipv_lines = MAX(1, MIN(lines, MAX_MULTIPV));
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Aspiration window search.
 //-------------------------------------------------------------------------------------------------
@@ -245,6 +711,7 @@ int search_asp(GAME *game, int incheck, int depth, int prev_score)
             alpha = prev_score - window;
             beta  = prev_score + window;
             score = search_pv(game, incheck, alpha, beta, depth);
+            root_moves_sort(game, game->search.pv_index, game->root_moves.count);
             if (game->search.abort)
                 return 0;
             if (score > alpha && score < beta)
@@ -254,7 +721,9 @@ int search_asp(GAME *game, int incheck, int depth, int prev_score)
         }
     }
 
-    return search_pv(game, incheck, -MAX_SCORE, MAX_SCORE, depth);
+    score = search_pv(game, incheck, -MAX_SCORE, MAX_SCORE, depth);
+    root_moves_sort(game, game->search.pv_index, game->root_moves.count);
+    return score;
 }
 
 //END
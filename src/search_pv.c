@@ -37,6 +37,10 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
     int     trans_score;
     int     reduced_beta;
     int     try_singular_extension;
+    int     improving;
+    int     root_index = 0;
+    U64     root_nodes = 0;
+    ROOT_MOVE   *root_move = NULL;
 
     assert(incheck == 0 || incheck == 1);
     assert(alpha >= -MAX_SCORE && alpha <= MAX_SCORE);
@@ -64,7 +68,9 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
     if (alpha >= beta) return alpha;
 
     //  Get move hint from transposition table
+    game->search.tt_probes++;
     trans_move = tt_move(&game->board);
+    if (trans_move != MOVE_NONE) game->search.tt_hits++;
 
     // Internal Iterative Deepening.
     if (depth > 3 && trans_move == MOVE_NONE) {
@@ -74,20 +80,31 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
         trans_move = tt_move(&game->board);
     }
 
+    //  Static evaluation to know if position is improving.
+    game->search.static_eval[ply] = incheck ? -MAX_SCORE : evaluate(game, alpha, beta);
+    improving = is_improving(game, ply);
+
     // Singular extension when there's a move from transposition table.
     if (trans_move != MOVE_NONE)
         try_singular_extension = TRUE;
     else
         try_singular_extension = FALSE;
 
+    //  At root, moves come from root list. In multi pv mode moves from previous lines are skipped.
+    if (ply == 0) {
+        root_index = game->search.pv_index;
+        for (int i = root_index; i < game->root_moves.count; i++) {
+            game->root_moves.moves[i].score = -MAX_SCORE;
+        }
+    }
+
     //  Loop through move list
     select_init(&ml, game, incheck, trans_move, FALSE);
-    while ((move = next_move(&ml)) != MOVE_NONE) {
+    select_sort_depth(&ml, depth);
+    while ((move = (ply == 0 ? next_root_move(game, &root_index) : next_move(&ml))) != MOVE_NONE) {
 
         assert(is_valid(&game->board, move));
 
-        if (!is_pseudo_legal(&game->board, ml.pins, move)) continue;
-        
         move_count++;
 
         reductions = 0;
@@ -116,7 +133,7 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
         // Pruning or depth reductions
         if (!incheck && !extensions && move_count > 1) {
 
-            assert(move != trans_move);
+            assert(ply == 0 || move != trans_move);
 
             // Quiet moves pruning/reductions
             if (move_is_quiet(move) && !is_free_pawn(&game->board, turn, move) && !is_killer(&game->move_order, turn, ply, move))  {
@@ -125,25 +142,25 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
 
                     // Futility pruning: eval + margin below beta.
                     if (depth < 10) {
-                        int pruning_margin = depth * (50 + get_pruning_margin(&game->move_order, turn, move));
+                        int pruning_margin = depth * (50 + get_pruning_margin(&game->move_order, &game->board, move));
                         if (evaluate(game, alpha, beta) + pruning_margin < alpha) {
                             continue;
                         }
                     }
 
-                    // Late move reductions: reduce depth for later moves
+                    // Late move reductions: reduce depth for later moves, from table (1/100 ply)
                     if (move_count > 3 && depth > 2) {
-                        reductions = 1;
-                        if (depth > 5 && get_has_bad_history(&game->move_order, turn, move)) {
-                            reductions += depth / 6;
-                        }
-                        reductions = MIN(reductions, 5);
+                        int lmr = lmr_reduction(depth, move_count) - LMR_PV;
+                        lmr += get_has_bad_history(&game->move_order, &game->board, move) ? LMR_HISTORY : -LMR_HISTORY;
+                        if (!improving) lmr += LMR_IMPROVING;
+                        reductions = MAX(1, MIN(lmr / 100, 5));
                     }
                 }
             }
         }
 
         // Make move and search new position.
+        root_nodes = game->search.nodes;
         make_move(&game->board, move);
 
         assert(valid_is_legal(&game->board, move));
@@ -164,18 +181,38 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
         undo_move(&game->board);
         if (game->search.abort) return 0;
 
+        if (move_is_capture(move)) {
+            save_capture_data(&game->move_order, turn, move, score >= beta);
+        }
+
+        //  Root move data: subtree size and score. Only first and best moves get a score.
+        if (ply == 0) {
+            root_move = &game->root_moves.moves[root_index - 1];
+            root_move->nodes += game->search.nodes - root_nodes;
+            if (move_count == 1 || score > alpha) {
+                root_move->score = score;
+                root_move->pv[0] = move;
+                root_move->pv_size = 1;
+            }
+        }
+
         //  Score verification.
         if (score > best_score) {
             if (score > alpha) {
                 update_pv(&game->pv_line, ply, move);
-                if (ply == 0) post_info(game, score, depth);
+                if (ply == 0) {
+                    root_move->pv_size = MIN(game->pv_line.pv_size[0], MAX_PLY);
+                    memcpy(root_move->pv, game->pv_line.pv_line[0], sizeof(MOVE) * root_move->pv_size);
+                    post_info(game, score, depth);
+                }
                 alpha = score;
                 best_move = move;
                 if (score >= beta) {
                     if (move_is_quiet(move)) {
                         save_beta_cutoff_data(&game->move_order, turn, ply, move, &ml, get_last_move_made(&game->board));
                     }
-                    tt_save(&game->board, depth, score, TT_LOWER, move);
+                    if (ply > 0 || game->search.pv_index == 0)
+                        tt_save(&game->board, depth, score, TT_LOWER, move);
                     return score;
                 }
             }
@@ -188,10 +225,13 @@ int search_pv(GAME *game, UINT incheck, int alpha, int beta, int depth)
         return (incheck ? -MATE_VALUE + ply : 0);
     }
 
-    if (best_move != MOVE_NONE) 
-        tt_save(&game->board, depth, best_score, TT_EXACT, best_move);
-    else
-        tt_save(&game->board, depth, best_score, TT_UPPER, MOVE_NONE);
+    // Root results of secondary multipv lines are not saved, they exclude the best moves.
+    if (ply > 0 || game->search.pv_index == 0) {
+        if (best_move != MOVE_NONE) 
+            tt_save(&game->board, depth, best_score, TT_EXACT, best_move);
+        else
+            tt_save(&game->board, depth, best_score, TT_UPPER, MOVE_NONE);
+    }
 
     return best_score;
 }
@@ -54,9 +54,12 @@ int quiesce(GAME *game, UINT incheck, int alpha, int beta, int depth)
     if (alpha >= beta) return alpha;
 
     // transposition table score or move hint
+    game->search.tt_probes++;
     if (tt_probe(&game->board, depth == 0 ? 0 : -1, alpha, beta, &score, &trans_move)) {
+        game->search.tt_hits++;
         return score;
     }
+    if (trans_move != MOVE_NONE) game->search.tt_hits++;
 
     if (!incheck) {
         best_score = evaluate(game, alpha, beta);
@@ -86,8 +89,6 @@ int quiesce(GAME *game, UINT incheck, int alpha, int beta, int depth)
             }
         }
 
-        if (!is_pseudo_legal(&game->board, ml.pins, move)) continue;
-
         gives_check = is_check(&game->board, move);
 
         make_move(&game->board, move);
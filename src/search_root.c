@@ -0,0 +1,115 @@
+/*-------------------------------------------------------------------------------
+  tucano is a XBoard chess playing engine developed by Alcides Schulz.
+  Copyright (C) 2011-present - Alcides Schulz
+
+  tucano is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tucano is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You can find the GNU General Public License at http://www.gnu.org/licenses/
+-------------------------------------------------------------------------------*/
+
+#include "globals.h"
+
+//-------------------------------------------------------------------------------------------------
+//  Root moves: list of legal moves at root with data collected by the search (scores, nodes
+//  and principal variation). The list is sorted after each search so the best moves are
+//  searched first in the next iteration.
+//-------------------------------------------------------------------------------------------------
+
+int     is_search_move(GAME *game, MOVE move);
+
+//-------------------------------------------------------------------------------------------------
+//  Generate legal moves at root. Initial order is given by the move selector. When a list of
+//  search moves was given, only those are searched.
+//-------------------------------------------------------------------------------------------------
+void root_moves_init(GAME *game)
+{
+    MOVE_LIST   ml;
+    MOVE        move;
+    ROOT_MOVES  *root_moves = &game->root_moves;
+
+    root_moves->count = 0;
+
+    select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), tt_move(&game->board), FALSE);
+    while ((move = next_move(&ml)) != MOVE_NONE) {
+        if (root_moves->count >= MAX_ROOT_MOVES) break;
+        if (!is_search_move(game, move)) continue;
+        ROOT_MOVE *root_move = &root_moves->moves[root_moves->count++];
+        root_move->move = move;
+        root_move->score = -MAX_SCORE;
+        root_move->prev_score = -MAX_SCORE;
+        root_move->nodes = 0;
+        root_move->pv[0] = move;
+        root_move->pv_size = 1;
+    }
+
+    //  None of the search moves is legal: ignore the list and search all moves.
+    if (root_moves->count == 0 && game->search.search_moves_count > 0) {
+        game->search.search_moves_count = 0;
+        root_moves_init(game);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Verify if move is in the search moves list. An empty list means all moves.
+//-------------------------------------------------------------------------------------------------
+int is_search_move(GAME *game, MOVE move)
+{
+    if (game->search.search_moves_count == 0) return TRUE;
+    for (int i = 0; i < game->search.search_moves_count; i++) {
+        if (game->search.search_moves[i] == move) return TRUE;
+    }
+    return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Prepare data for next iteration: current score becomes previous score.
+//-------------------------------------------------------------------------------------------------
+void root_moves_new_iteration(GAME *game)
+{
+    for (int i = 0; i < game->root_moves.count; i++) {
+        ROOT_MOVE *root_move = &game->root_moves.moves[i];
+        root_move->prev_score = root_move->score;
+        root_move->nodes = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Stable sort of root moves from first to last (exclusive) by score. Moves that were not the
+//  best (same score) are ordered by nodes searched: bigger trees are harder to refute.
+//-------------------------------------------------------------------------------------------------
+void root_moves_sort(GAME *game, int first, int last)
+{
+    ROOT_MOVE   *moves = game->root_moves.moves;
+    ROOT_MOVE   temp;
+
+    for (int i = first + 1; i < last; i++) {
+        if (moves[i - 1].score > moves[i].score) continue;
+        if (moves[i - 1].score == moves[i].score && moves[i - 1].nodes >= moves[i].nodes) continue;
+        temp = moves[i];
+        int j = i - 1;
+        while (j >= first && (moves[j].score < temp.score || (moves[j].score == temp.score && moves[j].nodes < temp.nodes))) {
+            moves[j + 1] = moves[j];
+            j--;
+        }
+        moves[j + 1] = temp;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Next move from root list.
+//-------------------------------------------------------------------------------------------------
+MOVE next_root_move(GAME *game, int *index)
+{
+    if (*index >= game->root_moves.count) return MOVE_NONE;
+    return game->root_moves.moves[(*index)++].move;
+}
+
+//END
@@ -40,6 +40,10 @@ void prepare_search(GAME *game, SETTINGS *settings)
     game->search.post_flag = settings->post_flag;
     game->search.use_book = settings->use_book;
     game->search.max_depth = settings->max_depth;
+    game->search.max_nodes = settings->max_nodes;
+    game->search.mate_in = settings->mate_in;
+    game->search.search_moves_count = settings->search_moves_count;
+    memcpy(game->search.search_moves, settings->search_moves, sizeof(MOVE) * settings->search_moves_count);
 
     //  Specific time per move
     if (settings->single_move_time > 0) {
@@ -74,8 +78,8 @@ void prepare_search(GAME *game, SETTINGS *settings)
         }
     }
 
-    // allocate time for this move
-    game->search.normal_move_time = settings->total_move_time / moves_to_go;
+    // allocate time for this move, most of the increment can be used as it is received back.
+    game->search.normal_move_time = settings->total_move_time / moves_to_go + settings->increment * 3 / 4;
 
     //  Calculate extended move time and allocate time buffer to avoid timeout
     game->search.extended_move_time = game->search.normal_move_time * 4;
@@ -111,6 +115,55 @@ void update_pv(PV_LINE *pv_line, int ply, MOVE move)
     pv_line->pv_size[ply] = pv_line->pv_size[ply + 1];
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Default values for late move reduction parameters, in 1/100 ply. Can be tuned with the "LMR"
+//  group of eval_tune.c parameters.
+//-------------------------------------------------------------------------------------------------
+void lmr_param_init(void)
+{
+    LMR_BASE = 75;
+    LMR_DIVISOR = 225;
+    LMR_HISTORY = 100;
+    LMR_IMPROVING = 100;
+    LMR_PV = 100;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Build late move reductions table: base + log(depth) * log(move count) / divisor.
+//-------------------------------------------------------------------------------------------------
+void lmr_init(void)
+{
+    int divisor = MAX(LMR_DIVISOR, 1);
+
+    for (int depth = 0; depth < MAX_DEPTH; depth++) {
+        for (int move_count = 0; move_count < LMR_MOVES; move_count++) {
+            if (depth == 0 || move_count == 0)
+                lmr_reductions[depth][move_count] = 0;
+            else
+                lmr_reductions[depth][move_count] = LMR_BASE + (int)(log(depth) * log(move_count) * 10000.0 / divisor);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Late move reduction in 1/100 ply for depth and move count.
+//-------------------------------------------------------------------------------------------------
+int lmr_reduction(int depth, int move_count)
+{
+    return lmr_reductions[MIN(depth, MAX_DEPTH - 1)][MIN(move_count, LMR_MOVES - 1)];
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Indicate if static evaluation is better than 2 plies before. Positions in check have no
+//  static evaluation and are considered improving.
+//-------------------------------------------------------------------------------------------------
+int is_improving(GAME *game, int ply)
+{
+    if (ply < 2) return TRUE;
+    if (game->search.static_eval[ply] == -MAX_SCORE || game->search.static_eval[ply - 2] == -MAX_SCORE) return TRUE;
+    return game->search.static_eval[ply] > game->search.static_eval[ply - 2];
+}
+
 //-------------------------------------------------------------------------------------------------
 //  Calculate and return the depth for null move search
 //-------------------------------------------------------------------------------------------------
@@ -120,18 +173,22 @@ int null_depth(int depth)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Check if time for search has ended.
+//  Check if node limit for search was reached. Time limit is controlled by the timer thread.
 //-------------------------------------------------------------------------------------------------
 void check_time(GAME *search_data)
 {
-    if (!search_data->is_main_thread) { // check time for main thread only
+    if (!search_data->is_main_thread || !search_data->search.max_nodes) { // check main thread only
+        return;
+    }
+    // node limit: main thread nodes are checked on every node, additional threads periodically.
+    if (search_data->search.nodes >= search_data->search.max_nodes) {
+        search_data->search.abort = TRUE;
         return;
     }
     if (search_data->search.nodes & TIME_CHECK) {
         return;
     }
-    UINT current_time = util_get_time();
-    if (current_time >= search_data->search.extended_finish_time) {
+    if (search_data->search.nodes + get_additional_threads_nodes() >= search_data->search.max_nodes) {
         search_data->search.abort = TRUE;
     }
 }
@@ -185,9 +242,20 @@ int is_eval_score(int score)
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Display search information on screen.
+//  Display search information on screen. With multi PV the lines are printed only after the
+//  iteration, sorted by score (search_multipv).
 //-------------------------------------------------------------------------------------------------
 void post_info(GAME *game, int score, int depth)
+{
+    if (game->search.multipv > 1) return;
+
+    post_line(game, score, depth, game->pv_line.pv_line[0], game->pv_line.pv_size[0], 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print one principal variation line. multipv is the line number for UCI or 0 if not used.
+//-------------------------------------------------------------------------------------------------
+void post_line(GAME *game, int score, int depth, MOVE *pv, int pv_size, int multipv)
 {
     if (game->search.post_flag == POST_NONE) return;
 
@@ -237,6 +305,7 @@ void post_info(GAME *game, int score, int depth)
         }
         printf("info ");
         printf("depth %d ", depth);
+        if (multipv) printf("multipv %d ", multipv);
         printf("score %s %d ", score_type, uci_score);
         printf("time %d ", elapsed_milliseconds);
         printf("nodes %" PRIu64 " ", total_node_count);
@@ -249,8 +318,8 @@ void post_info(GAME *game, int score, int depth)
 
     // print pv (works for all options above)
     char move_string[20];
-    for (int pvi = 0; pvi < game->pv_line.pv_size[0]; pvi++) {
-        util_get_move_string(game->pv_line.pv_line[0][pvi], move_string);
+    for (int pvi = 0; pvi < pv_size; pvi++) {
+        util_get_move_string(pv[pvi], move_string);
         printf(" %s", move_string);
     }
 
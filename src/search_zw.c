@@ -70,9 +70,14 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
     if (alpha >= beta) return alpha;
 
     // transposition table score or move hint
-    if (exclude_move == MOVE_NONE && tt_probe(&game->board, depth, beta - 1, beta, &score, &trans_move)) {
-        assert(score >= -MAX_SCORE && score <= MAX_SCORE);
-        return score;
+    if (exclude_move == MOVE_NONE) {
+        game->search.tt_probes++;
+        if (tt_probe(&game->board, depth, beta - 1, beta, &score, &trans_move)) {
+            assert(score >= -MAX_SCORE && score <= MAX_SCORE);
+            game->search.tt_hits++;
+            return score;
+        }
+        if (trans_move != MOVE_NONE) game->search.tt_hits++;
     }
 
 #ifdef EGTB_SYZYGY
@@ -104,6 +109,10 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
     }
 #endif 
 
+    //  Static evaluation to know if position is improving.
+    game->search.static_eval[ply] = incheck ? -MAX_SCORE : evaluate(game, beta - 1, beta);
+    int improving = is_improving(game, ply);
+
     // Razoring
     if (exclude_move == MOVE_NONE && !incheck && depth < RAZOR_DEPTH && !is_mate_score(beta)) {
         if (evaluate(game, beta - 1, beta) + RAZOR_MARGIN[depth] < beta && !has_pawn_on_rank7(&game->board, turn)) {
@@ -147,7 +156,6 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
         select_init(&mlpc, game, incheck, trans_move, TRUE);
         while ((move = next_move(&mlpc)) != MOVE_NONE) {
             if (move_is_quiet(move) || eval_score + see_move(&game->board, move) < beta_cut) continue;
-            if (!is_pseudo_legal(&game->board, mlpc.pins, move)) continue;
             make_move(&game->board, move);
             score = -search_zw(game, is_incheck(&game->board, side_on_move(&game->board)), 1 - beta_cut, depth - 4, FALSE, MOVE_NONE, 0);
             undo_move(&game->board);
@@ -157,12 +165,11 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
     }
 
     select_init(&ml, game, incheck, trans_move, FALSE);
+    select_sort_depth(&ml, depth);
     while ((move = next_move(&ml)) != MOVE_NONE) {
 
         assert(is_valid(&game->board, move));
 
-        if (!is_pseudo_legal(&game->board, ml.pins, move)) continue;
-
         move_count++;
 
         if (move == exclude_move)  continue;
@@ -187,7 +194,7 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
 
                 if (!is_counter_move(&game->move_order, flip_color(turn), get_last_move_made(&game->board), move)) {
                     
-                    int move_has_bad_history = get_has_bad_history(&game->move_order, turn, move);
+                    int move_has_bad_history = get_has_bad_history(&game->move_order, &game->board, move);
                     
                     // Move count pruning: prune late moves based on move count.
                     if (!incheck && move_has_bad_history) {
@@ -205,22 +212,30 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
 
                     // Futility pruning: eval + margin below beta. Uses beta cutoff history.
                     if (!incheck && depth < 10) {
-                        int pruning_margin = depth * (50 + get_pruning_margin(&game->move_order, turn, move));
+                        int pruning_margin = depth * (50 + get_pruning_margin(&game->move_order, &game->board, move));
                         if (eval_score + pruning_margin < beta) {
                             continue;
                         }
                     }
 
-                    // Late move reductions: reduce depth for later moves
+                    // Late move reductions: reduce depth for later moves, from table (1/100 ply)
                     if (move_count > 3 && depth > 2) {
-                        reductions = 1;
-                        if (!incheck && depth > 5 && move_has_bad_history) {
-                            reductions += depth / 6 + move_count / 6;
+                        int lmr = lmr_reduction(depth, move_count);
+                        if (!incheck) {
+                            lmr += move_has_bad_history ? LMR_HISTORY : -LMR_HISTORY;
+                            if (!improving) lmr += LMR_IMPROVING;
                         }
-                        reductions = MIN(reductions, 10);
+                        reductions = MAX(1, MIN(lmr / 100, 10));
                     }
                 }
             }
+
+            // Losing captures with bad capture history are reduced too.
+            if (move_is_capture(move) && !incheck && is_bad_capture(&ml) && move_count > 3 && depth > 2) {
+                if (get_capture_cutoff_percent(&game->move_order, turn, move) < 30) {
+                    reductions = 1;
+                }
+            }
         }
 
         // Make move and search new position.
@@ -237,6 +252,10 @@ int search_zw(GAME *game, UINT incheck, int beta, int depth, UINT can_null, MOVE
         undo_move(&game->board);
         if (game->search.abort) return 0;
 
+        if (move_is_capture(move) && exclude_move == MOVE_NONE) {
+            save_capture_data(&game->move_order, turn, move, score >= beta);
+        }
+
         // score verification
         if (score > best_score) {
             if (score >= beta) {
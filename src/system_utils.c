@@ -15,6 +15,11 @@
   You can find the GNU General Public License at http://www.gnu.org/licenses/
 -------------------------------------------------------------------------------*/
 
+// Needed for clock_gettime.
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
 #include "globals.h"
 
 //-------------------------------------------------------------------------------------------------
@@ -45,19 +50,79 @@
 
 #endif
 
+static U64 base_time = 0;
+
+//-------------------------------------------------------------------------------------------------
+//  Set the base of util_get_time. Called once at startup, before other threads are created.
+//-------------------------------------------------------------------------------------------------
+void util_time_init(void)
+{
+    base_time = util_get_time_ns();
+}
+
 //-------------------------------------------------------------------------------------------------
-//  Current time
+//  Current time in milliseconds. Monotonic clock counted from util_time_init, so it does not
+//  jump when the system clock is adjusted.
 //-------------------------------------------------------------------------------------------------
 UINT util_get_time(void)
+{
+    return (UINT)((util_get_time_ns() - base_time) / 1000000ULL);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Monotonic time in nanoseconds, used to measure short intervals.
+//-------------------------------------------------------------------------------------------------
+U64 util_get_time_ns(void)
 {
 #if defined(IS_WINDOWS)
-    FILETIME ft;
-    GetSystemTimeAsFileTime(&ft);
-    return (unsigned int) ((((U64)ft.dwHighDateTime << 32) | ft.dwLowDateTime) / 10000);
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (U64)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL + (U64)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / (U64)frequency.QuadPart;
 #else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (U64)ts.tv_sec * 1000000000ULL + (U64)ts.tv_nsec;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Initialize a condition variable used with timed waits. On Linux it uses the monotonic clock.
+//-------------------------------------------------------------------------------------------------
+void util_timed_cond_init(COND *cond)
+{
+#if defined(IS_WINDOWS)
+    InitializeConditionVariable(cond);
+#elif defined(__linux__)
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Wait on condition variable for a signal or until timeout (nanoseconds) expires.
+//-------------------------------------------------------------------------------------------------
+void util_timed_cond_wait(COND *cond, MUTEX *mutex, U64 timeout)
+{
+#if defined(IS_WINDOWS)
+    SleepConditionVariableCS(cond, mutex, (DWORD)((timeout + 999999ULL) / 1000000ULL));
+#else
+    struct timespec ts;
+#if defined(__linux__)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+    U64 wake_time = (U64)ts.tv_sec * 1000000000ULL + (U64)ts.tv_nsec + timeout;
+    ts.tv_sec = (time_t)(wake_time / 1000000000ULL);
+    ts.tv_nsec = (long)(wake_time % 1000000000ULL);
+    pthread_cond_timedwait(cond, mutex, &ts);
 #endif
 }
 
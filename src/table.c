@@ -15,22 +15,34 @@
   You can find the GNU General Public License at http://www.gnu.org/licenses/
 -------------------------------------------------------------------------------*/
 
+// Needed for posix_memalign and madvise.
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
 #include "globals.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 //-------------------------------------------------------------------------------------------------
 //  Transposition (hash) table functions.
+//
+//  Each entry (bucket) has 4 records and is aligned to a 64 bytes cache line. Records are stored
+//  using lockless hashing: the key field keeps the position key xor'ed with the data field. A
+//  record partially written by another thread will not match the position key when read.
+//  Bucket index uses the high 32 bits of the key, verification uses the full key.
 //-------------------------------------------------------------------------------------------------
 
-#define TT_BUCKETS  4
+#define TT_BUCKETS      4
+#define TT_ALIGNMENT    64
+#define TT_HUGE_PAGE    (2 * 1024 * 1024)
 
 typedef struct strans_record
 {
-    U32     key;
-    MOVE    best_move;
-    S32     search_score;
-    S16     age;
-    S8      depth;
-    S8      flag;
+    U64     key;    // position key xor data
+    U64     data;   // best move, score, depth, flag and age
 }   TT_REC;
 
 typedef struct trans_entry 
@@ -38,10 +50,60 @@ typedef struct trans_entry
     TT_REC  record[TT_BUCKETS];
 }   TT_ENTRY;
 
+// Data field layout: move (32 bits), score (16), depth (8), flag (2), age (6).
+#define TT_AGE_MASK         0x3F
+#define TT_PACK(m,s,d,f,a)  ((U64)(U32)(m) | ((U64)(U16)(S16)(s) << 32) | ((U64)(U8)(S8)(d) << 48) | ((U64)(f) << 56) | ((U64)(a) << 58))
+#define TT_MOVE(data)       ((MOVE)(data))
+#define TT_SCORE(data)      ((int)(S16)((data) >> 32))
+#define TT_DEPTH(data)      ((int)(S8)((data) >> 48))
+#define TT_FLAG(data)       ((int)((data) >> 56) & 0x03)
+#define TT_AGE(data)        ((int)((data) >> 58) & TT_AGE_MASK)
+#define TT_INDEX(key)       ((size_t)((key) >> 32) & trans_mask)
+#define TT_VERIFY(key,data) ((key) ^ (data) ^ trans_salt)
+
+typedef struct s_trans_clear
+{
+    char    *start;
+    size_t  size;
+    int     index;          // worker number
+    int     clear_id;       // last clear seen by the worker
+}   TT_CLEAR;
+
 TT_ENTRY    *trans_table = 0;
+void        *trans_memory = 0;
 size_t      trans_size;
-int         trans_entries;
+size_t      trans_entries;
+size_t      trans_mask;
 S16         trans_age;
+U64         trans_salt = 0;
+int         trans_threads = 1;
+char        *trans_page_mode = "none";
+
+// Background clear control. Clear workers are created once and wait for the next clear.
+MUTEX       trans_clear_lock;
+COND        trans_clear_event;
+COND        trans_clear_done;
+int         trans_clear_lock_init = FALSE;
+int         trans_clear_pending = FALSE;
+int         trans_clear_new_game = TRUE;
+int         trans_clear_threads = 0;
+int         trans_clear_id = 0;
+int         trans_clear_active = 0;
+int         trans_clear_workers = 0;
+TT_CLEAR    trans_clear_chunk[MAX_THREADS];
+THREAD_ID   trans_clear_handle[MAX_THREADS];
+UINT        trans_clear_start_time = 0;
+UINT        trans_clear_time = 0;
+
+void        *tt_alloc(size_t size);
+void        tt_free(void);
+void        tt_clear_worker(TT_CLEAR *chunk);
+
+// Statistics, collected only when enabled by tt_stats_reset. Updated by all search threads.
+int         tt_stats_enabled = FALSE;
+U64         tt_stats_probes;
+U64         tt_stats_hits;
+U64         tt_stats_collisions;
 
 //-------------------------------------------------------------------------------------------------
 //  Initialization.
@@ -49,33 +111,226 @@ S16         trans_age;
 void tt_init(size_t size_mb)
 {
     assert(sizeof(TT_REC) == 16);
+    assert(sizeof(TT_ENTRY) == TT_ALIGNMENT);
+
+    if (!trans_clear_lock_init) {
+        MUTEX_INIT(trans_clear_lock);
+        COND_INIT(trans_clear_event);
+        COND_INIT(trans_clear_done);
+        trans_clear_lock_init = TRUE;
+    }
 
-    if (trans_table) free(trans_table);
+    tt_clear_wait();
+    if (trans_memory) tt_free();
 
     trans_size = 2;
     while (trans_size * 2 <= size_mb) {
         trans_size *= 2;
     }
     trans_size = trans_size * 1024 * 1024;
-    trans_table = (TT_ENTRY *)malloc(trans_size);
+    trans_table = (TT_ENTRY *)tt_alloc(trans_size);
     if (!trans_table)  {
         printf("no memory for transposition table!");
         exit(-1);
     }
-    trans_entries = (int)(trans_size / sizeof(TT_ENTRY));
+    trans_entries = trans_size / sizeof(TT_ENTRY);
+    trans_mask = trans_entries - 1;
     
-    assert(trans_entries * (int)sizeof(TT_ENTRY) == trans_size);
+    assert(trans_entries * sizeof(TT_ENTRY) == trans_size);
+    assert((trans_entries & trans_mask) == 0);
+    assert(((uintptr_t)trans_table & (TT_ALIGNMENT - 1)) == 0);
+
+    tt_clear_start();
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Allocate table memory aligned to the page size. Use huge (2 MB) or large pages when the
+//  system provides them, reducing TLB misses on big tables.
+//-------------------------------------------------------------------------------------------------
+void *tt_alloc(size_t size)
+{
+#if defined(_WIN32)
+    SIZE_T  large_page = GetLargePageMinimum();
+
+    // Large pages require the "Lock pages in memory" privilege, otherwise it fails.
+    trans_memory = NULL;
+    if (large_page && size % large_page == 0) {
+        trans_memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        trans_page_mode = "large pages";
+    }
+    if (!trans_memory) {
+        trans_memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        trans_page_mode = "normal pages";
+    }
+    return trans_memory;
+#elif defined(__linux__)
+    if (posix_memalign(&trans_memory, TT_HUGE_PAGE, size)) {
+        trans_memory = NULL;
+        return NULL;
+    }
+    trans_page_mode = "normal pages";
+#ifdef MADV_HUGEPAGE
+    // Only a hint: the kernel may still back the table with normal pages.
+    if (!madvise(trans_memory, size, MADV_HUGEPAGE)) trans_page_mode = "huge pages requested";
+#endif
+    return trans_memory;
+#else
+    trans_memory = malloc(size + TT_ALIGNMENT - 1);
+    if (!trans_memory) return NULL;
+    trans_page_mode = "normal pages";
+    return (void *)(((uintptr_t)trans_memory + TT_ALIGNMENT - 1) & ~(uintptr_t)(TT_ALIGNMENT - 1));
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Release table memory.
+//-------------------------------------------------------------------------------------------------
+void tt_free(void)
+{
+#if defined(_WIN32)
+    VirtualFree(trans_memory, 0, MEM_RELEASE);
+#else
+    free(trans_memory);
+#endif
+    trans_memory = NULL;
+    trans_table = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Number of threads used to clear the table, same as search threads.
+//-------------------------------------------------------------------------------------------------
+void tt_set_threads(int threads)
+{
+    trans_threads = threads < 1 ? 1 : threads;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Clear worker: wait for a new clear and clear its part of the table. Workers beyond the number
+//  of chunks of the current clear have nothing to do.
+//-------------------------------------------------------------------------------------------------
+void tt_clear_worker(TT_CLEAR *chunk)
+{
+    MUTEX_LOCK(trans_clear_lock);
 
-    tt_clear();
+    while (TRUE) {
+        while (chunk->clear_id == trans_clear_id) {
+            COND_WAIT(trans_clear_event, trans_clear_lock);
+        }
+        chunk->clear_id = trans_clear_id;
+        if (chunk->index >= trans_clear_threads) continue;
+        MUTEX_UNLOCK(trans_clear_lock);
+
+        memset(chunk->start, 0, chunk->size);
+
+        MUTEX_LOCK(trans_clear_lock);
+        if (--trans_clear_active == 0) COND_SIGNAL(trans_clear_done);
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Clear.
+//  Clear. The table is divided in chunks cleared in parallel. On a new allocation this is the
+//  first write to the memory, so the pages are distributed among the NUMA nodes running the
+//  clearing threads (first touch).
 //-------------------------------------------------------------------------------------------------
 void tt_clear(void)
 {
-    memset(trans_table, 0, trans_size);
-    trans_age = 0;
+    tt_clear_start();
+    tt_clear_wait();
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Start clearing the table in background worker threads and return. Search must call tt_clear_wait
+//  before using the table. If a clear is already running there is nothing to do.
+//-------------------------------------------------------------------------------------------------
+void tt_clear_start(void)
+{
+    MUTEX_LOCK(trans_clear_lock);
+
+    if (!trans_clear_pending) {
+        int threads = trans_threads;
+
+        // Keep chunks multiple of huge page size.
+        if ((size_t)threads > trans_size / TT_HUGE_PAGE) threads = (int)(trans_size / TT_HUGE_PAGE);
+        if (threads < 1) threads = 1;
+
+        size_t chunk_size = (trans_size / threads) & ~(size_t)(TT_HUGE_PAGE - 1);
+        if (chunk_size == 0) chunk_size = trans_size;
+
+        trans_clear_start_time = util_get_time();
+        for (int i = 0; i < threads; i++) {
+            trans_clear_chunk[i].start = (char *)trans_table + chunk_size * i;
+            trans_clear_chunk[i].size = i == threads - 1 ? trans_size - chunk_size * i : chunk_size;
+        }
+        for (; trans_clear_workers < threads; trans_clear_workers++) {
+            trans_clear_chunk[trans_clear_workers].index = trans_clear_workers;
+            trans_clear_chunk[trans_clear_workers].clear_id = trans_clear_id;
+            THREAD_CREATE(trans_clear_handle[trans_clear_workers], tt_clear_worker, &trans_clear_chunk[trans_clear_workers]);
+        }
+        trans_clear_threads = threads;
+        trans_clear_active = threads;
+        trans_clear_id++;
+        COND_BROADCAST(trans_clear_event);
+        trans_clear_pending = TRUE;
+        trans_age = 0;
+    }
+
+    MUTEX_UNLOCK(trans_clear_lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Wait for a background clear to finish. Returns TRUE if there was a clear running.
+//-------------------------------------------------------------------------------------------------
+int tt_clear_wait(void)
+{
+    int     waited = FALSE;
+
+    if (!trans_clear_lock_init) return FALSE;
+
+    MUTEX_LOCK(trans_clear_lock);
+
+    if (trans_clear_pending) {
+        while (trans_clear_active > 0) {
+            COND_WAIT(trans_clear_done, trans_clear_lock);
+        }
+        trans_clear_time = util_get_time() - trans_clear_start_time;
+        trans_clear_pending = FALSE;
+        waited = TRUE;
+    }
+
+    MUTEX_UNLOCK(trans_clear_lock);
+
+    return waited;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Prepare table for a new game. Instead of clearing, entries can be invalidated by changing the
+//  key salt used in verification. Old entries will be replaced by new ones as the table ages.
+//-------------------------------------------------------------------------------------------------
+void tt_new_game(void)
+{
+    if (trans_clear_new_game) {
+        tt_clear_start();
+    }
+    else {
+        trans_salt = trans_salt * 6364136223846793005ULL + 1442695040888963407ULL;
+        tt_age();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Select clear or invalidation for new games.
+//-------------------------------------------------------------------------------------------------
+void tt_set_clear_new_game(int clear)
+{
+    trans_clear_new_game = clear;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Print memory information: page mode and time of last clear.
+//-------------------------------------------------------------------------------------------------
+void tt_print_info(char *prefix)
+{
+    printf("%sHash %d MB, %s, cleared in %u ms using %d threads\n", prefix, (int)(trans_size / (1024 * 1024)), trans_page_mode, trans_clear_time, trans_clear_threads);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -83,7 +338,7 @@ void tt_clear(void)
 //-------------------------------------------------------------------------------------------------
 void tt_age(void)
 {
-    trans_age++;
+    trans_age = (trans_age + 1) & TT_AGE_MASK;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -91,35 +346,37 @@ void tt_age(void)
 //-------------------------------------------------------------------------------------------------
 void tt_save(BOARD *board, int depth, int search_score, S8 flag, MOVE best_move)
 {
-    int     idx = board_key(board) % trans_entries;
+    U64     key = board_key(board);
+    size_t  idx = TT_INDEX(key);
     int     rec;
+    U64     data;
     TT_REC  *record1 = NULL;
     TT_REC  *record2 = NULL;
     int     depth_replace_age = MAX_DEPTH + 1;
     int     depth_replace = MAX_DEPTH + 1;
 
-    assert(idx >= 0 && idx < trans_entries);
+    assert(idx < trans_entries);
     assert(depth >= -1 && depth <= MAX_DEPTH);
     assert(flag == TT_LOWER || flag == TT_UPPER || flag == TT_EXACT);
     assert(search_score >= -MAX_SCORE && search_score <= MAX_SCORE);
     
     // Locate record to store information.
     for (rec = 0; rec < TT_BUCKETS; rec++)  {
-        if (trans_table[idx].record[rec].key == LOW32(board_key(board))) {
-            record1 = &trans_table[idx].record[rec];
+        TT_REC *record = &trans_table[idx].record[rec];
+        data = record->data;
+        if (TT_VERIFY(record->key, data) == key) {
+            record1 = record;
             if (best_move == MOVE_NONE)
-                best_move = record1->best_move;
+                best_move = TT_MOVE(data);
             break;
         }
-        if (trans_table[idx].record[rec].age != trans_age && 
-            trans_table[idx].record[rec].depth < depth_replace_age) 
-        {
-            record1 = &trans_table[idx].record[rec];
-            depth_replace_age = trans_table[idx].record[rec].depth;
+        if (TT_AGE(data) != trans_age && TT_DEPTH(data) < depth_replace_age) {
+            record1 = record;
+            depth_replace_age = TT_DEPTH(data);
         }
-        if (trans_table[idx].record[rec].depth < depth_replace) {
-            record2 = &trans_table[idx].record[rec];
-            depth_replace = trans_table[idx].record[rec].depth;
+        if (TT_DEPTH(data) < depth_replace) {
+            record2 = record;
+            depth_replace = TT_DEPTH(data);
         }
     }
 
@@ -139,12 +396,9 @@ void tt_save(BOARD *board, int depth, int search_score, S8 flag, MOVE best_move)
     }
 
     // Store entry
-    record1->key = LOW32(board_key(board));
-    record1->depth = (S8)depth;
-    record1->age = trans_age;
-    record1->flag = flag;
-    record1->search_score = search_score;
-    record1->best_move = best_move;
+    data = TT_PACK(best_move, search_score, depth, flag, trans_age);
+    record1->key = TT_VERIFY(key, data);
+    record1->data = data;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -152,30 +406,44 @@ void tt_save(BOARD *board, int depth, int search_score, S8 flag, MOVE best_move)
 //-------------------------------------------------------------------------------------------------
 int tt_probe(BOARD *board, int depth, int alpha, int beta, int *search_score, MOVE *best_move)
 {
-    int     idx = board_key(board) % trans_entries;
+    U64     key = board_key(board);
+    size_t  idx = TT_INDEX(key);
     int     rec;
+    U64     data;
+    U64     rec_key;
     int     tt_depth;
-    S8      tt_flag;
+    int     tt_flag;
 
     assert(depth >= -1 && depth <= MAX_DEPTH);
     assert(alpha < beta);
-    assert(idx >= 0 && idx < trans_entries);
+    assert(idx < trans_entries);
 
     *search_score = 0;
     *best_move = MOVE_NONE;
+
+    if (tt_stats_enabled) ATOMIC_ADD64(&tt_stats_probes, 1);
     
     for (rec = 0; rec < TT_BUCKETS; rec++) {
+        TT_REC *record = &trans_table[idx].record[rec];
+        data = record->data;
+        rec_key = TT_VERIFY(record->key, data);
+
+        if (rec_key != key) {
+            // Match by the previous 32 bits verification: torn record or key collision.
+            if (tt_stats_enabled && data != 0 && LOW32(rec_key) == LOW32(key)) ATOMIC_ADD64(&tt_stats_collisions, 1);
+            continue;
+        }
 
-        if (trans_table[idx].record[rec].key != LOW32(board_key(board))) continue;
+        if (tt_stats_enabled) ATOMIC_ADD64(&tt_stats_hits, 1);
 
-        tt_depth = trans_table[idx].record[rec].depth;
-        tt_flag = trans_table[idx].record[rec].flag;
+        tt_depth = TT_DEPTH(data);
+        tt_flag = TT_FLAG(data);
 
         assert(tt_depth >= -1 && tt_depth <= MAX_DEPTH);
         assert(tt_flag == TT_EXACT || tt_flag == TT_LOWER || tt_flag == TT_UPPER);
 
-        *best_move = trans_table[idx].record[rec].best_move;
-        *search_score = trans_table[idx].record[rec].search_score;
+        *best_move = TT_MOVE(data);
+        *search_score = TT_SCORE(data);
 
         if (tt_depth >= depth) {
             if (*search_score >= MATE_VALUE - MAX_PLY && *search_score <= MATE_VALUE) {
@@ -188,7 +456,11 @@ int tt_probe(BOARD *board, int depth, int alpha, int beta, int *search_score, MO
                 (tt_flag == TT_LOWER && *search_score >= beta) ||
                 (tt_flag == TT_EXACT))
             {
-                trans_table[idx].record[rec].age = trans_age;
+                if (TT_AGE(data) != trans_age) {
+                    data = (data & ~((U64)TT_AGE_MASK << 58)) | ((U64)trans_age << 58);
+                    record->key = TT_VERIFY(key, data);
+                    record->data = data;
+                }
                 return TRUE;
             }
         }
@@ -199,18 +471,29 @@ int tt_probe(BOARD *board, int depth, int alpha, int beta, int *search_score, MO
 }
 
 //-------------------------------------------------------------------------------------------------
-//  Return best move for current position.
+//  Return best move for current position. This is the table probe of PV nodes, so it is counted
+//  in the statistics like tt_probe.
 //-------------------------------------------------------------------------------------------------
 MOVE tt_move(BOARD *board)
 {
-    int        idx = board_key(board) % trans_entries;
-    int        rec;
+    U64     key = board_key(board);
+    size_t  idx = TT_INDEX(key);
+    int     rec;
+    U64     data;
+    U64     rec_key;
+
+    assert(idx < trans_entries);
 
-    assert(idx >= 0 && idx < trans_size);
+    if (tt_stats_enabled) ATOMIC_ADD64(&tt_stats_probes, 1);
 
     for (rec = 0; rec < TT_BUCKETS; rec++) {
-        if (trans_table[idx].record[rec].key == LOW32(board_key(board)))
-            return trans_table[idx].record[rec].best_move;
+        data = trans_table[idx].record[rec].data;
+        rec_key = TT_VERIFY(trans_table[idx].record[rec].key, data);
+        if (rec_key == key) {
+            if (tt_stats_enabled) ATOMIC_ADD64(&tt_stats_hits, 1);
+            return TT_MOVE(data);
+        }
+        if (tt_stats_enabled && data != 0 && LOW32(rec_key) == LOW32(key)) ATOMIC_ADD64(&tt_stats_collisions, 1);
     }
     return MOVE_NONE;
 }
@@ -219,18 +502,21 @@ MOVE tt_move(BOARD *board)
 //  Return score and if is suitable for singular extension.
 //-------------------------------------------------------------------------------------------------
 int tt_score(BOARD *board, int min_depth, int *tt_score) {
-    int        idx = board_key(board) % trans_entries;
-    int        rec;
+    U64     key = board_key(board);
+    size_t  idx = TT_INDEX(key);
+    int     rec;
+    U64     data;
     int     tt_depth;
-    S8      tt_flag;
+    int     tt_flag;
 
-    assert(idx >= 0 && idx < trans_size);
+    assert(idx < trans_entries);
 
     for (rec = 0; rec < TT_BUCKETS; rec++) {
-        if (trans_table[idx].record[rec].key == LOW32(board_key(board)))  {
-            tt_depth  = trans_table[idx].record[rec].depth;
-            tt_flag   = trans_table[idx].record[rec].flag;
-            *tt_score = trans_table[idx].record[rec].search_score;
+        data = trans_table[idx].record[rec].data;
+        if (TT_VERIFY(trans_table[idx].record[rec].key, data) == key)  {
+            tt_depth  = TT_DEPTH(data);
+            tt_flag   = TT_FLAG(data);
+            *tt_score = TT_SCORE(data);
             if (tt_flag == TT_LOWER || tt_flag == TT_EXACT) {
                 if (tt_depth >= min_depth && *tt_score > -MAX_EVAL && *tt_score < MAX_EVAL)  {
                     return TRUE;
@@ -242,5 +528,27 @@ int tt_score(BOARD *board, int min_depth, int *tt_score) {
     return FALSE;
 }
 
-//END
+//-------------------------------------------------------------------------------------------------
+//  Reset and enable statistics collection.
+//-------------------------------------------------------------------------------------------------
+void tt_stats_reset(int enable)
+{
+    tt_stats_probes = 0;
+    tt_stats_hits = 0;
+    tt_stats_collisions = 0;
+    tt_stats_enabled = enable;
+}
 
+//-------------------------------------------------------------------------------------------------
+//  Print probe statistics. Collisions are records accepted by a 32 bits key check but rejected
+//  by the full key verification (key collisions or torn writes).
+//-------------------------------------------------------------------------------------------------
+void tt_stats_print(void)
+{
+    double  probes = tt_stats_probes ? (double)tt_stats_probes : 1.0;
+
+    printf("Hash: probes: %" PRIu64 "  hits: %3.2f%%  collisions: %" PRIu64 " (%3.3f per million probes)\n",
+        tt_stats_probes, 100.0 * (double)tt_stats_hits / probes, tt_stats_collisions, 1000000.0 * (double)tt_stats_collisions / probes);
+}
+
+//END
@@ -30,8 +30,6 @@ int is_move_in_list(GAME *game, MOVE test_move)
 
     select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), MOVE_NONE, FALSE);
     while ((move = next_move(&ml)) != MOVE_NONE)  {
-        if (!is_pseudo_legal(&game->board, ml.pins, move))
-            continue;
         if (move == test_move)
             return TRUE;
     }
@@ -269,6 +267,24 @@ int valid_material(BOARD *board)
     return TRUE;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Incremental material and PST scores match the values calculated from scratch.
+//-------------------------------------------------------------------------------------------------
+int valid_eval_accumulators(BOARD *board)
+{
+    for (int color = WHITE; color <= BLACK; color++) {
+        if (board->material[color] != eval_material_calc(board, color)) {
+            printf("incremental material error color=%d\n", color);
+            return FALSE;
+        }
+        if (board->pst[color] != eval_pst_calc(board, color)) {
+            printf("incremental pst error color=%d\n", color);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
 //  Assert valid square
 int valid_square(int square)
 {
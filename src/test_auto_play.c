@@ -32,7 +32,7 @@ void auto_play(int total_games, SETTINGS *settings)
     char        move_string[20];
     GAME        *game;
 
-    game = (GAME *)malloc(sizeof(GAME));
+    game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "auto_play.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -59,6 +59,8 @@ void auto_play(int total_games, SETTINGS *settings)
         print_game_result(game);
     }
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 }
 
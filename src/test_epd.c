@@ -41,7 +41,7 @@ void epd(char *file, SETTINGS *settings)
     int     correct = 0;
     double  percent = 0;
 
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "epd.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -122,6 +122,8 @@ void epd(char *file, SETTINGS *settings)
 
     fclose(f);
     fclose(failed);
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 }
 
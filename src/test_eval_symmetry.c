@@ -42,7 +42,7 @@ void eval_test(char *file)
     int     eval_ranks;
     int     eval_files;
     
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "eval_test.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -90,6 +90,8 @@ void eval_test(char *file)
 
     printf("number of tests: %d   ranks: %d  files: %d\n", count, correct_ranks, correct_files);
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
     fclose(f);
 }
@@ -0,0 +1,191 @@
+/*-------------------------------------------------------------------------------
+  tucano is a XBoard chess playing engine developed by Alcides Schulz.
+  Copyright (C) 2011-present - Alcides Schulz
+
+  tucano is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tucano is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You can find the GNU General Public License at http://www.gnu.org/licenses/
+-------------------------------------------------------------------------------*/
+
+#include "globals.h"
+
+//-------------------------------------------------------------------------------------------------
+//  Fuzz test for hash move validation: random move values are tested with is_valid and is_legal
+//  and the result must be the same as searching the move in the list of legal moves.
+//-------------------------------------------------------------------------------------------------
+
+#define FUZZ_MAX_ERRORS     10
+
+U32     fuzz_random(void);
+MOVE    fuzz_move(BOARD *board, MOVE *legal, int legal_count, MOVE *prev, int prev_count);
+int     fuzz_in_list(MOVE move, MOVE *list, int count);
+
+U64     fuzz_seed = 0x9E3779B97F4A7C15;
+
+//-------------------------------------------------------------------------------------------------
+//  Reads positions from epd file and tests random moves for each one.
+//-------------------------------------------------------------------------------------------------
+void fuzz_test(char *file, int moves_per_position)
+{
+    FILE        *f;
+    char        line[1000];
+    char        fields[4][100];
+    char        fen[1000];
+    MOVE        legal[MAX_MOVE];
+    MOVE        prev[MAX_MOVE];
+    int         legal_count;
+    int         prev_count = 0;
+    MOVE        move;
+    MOVE_LIST   ml;
+    U64         pins;
+    int         incheck;
+    int         expected;
+    int         result;
+    int         made;
+    int         positions = 0;
+    U64         tested = 0;
+    U64         accepted = 0;
+    U64         errors = 0;
+
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
+    if (game == NULL) {
+        fprintf(stderr, "fuzz_test.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
+        return;
+    }
+
+    f = fopen(file, "r");
+    if (f == NULL) {
+        printf("fuzz_test: cannot open epd file: %s\n", file);
+        free(game);
+        return;
+    }
+
+    UINT start = util_get_time();
+
+    while (fgets(line, 1000, f) != NULL) {
+        if (sscanf(line, "%99s %99s %99s %99s", fields[0], fields[1], fields[2], fields[3]) != 4) continue;
+        sprintf(fen, "%s %s %s %s 0 1", fields[0], fields[1], fields[2], fields[3]);
+        positions++;
+
+        new_game(game, fen);
+
+        incheck = is_incheck(&game->board, side_on_move(&game->board));
+        pins = find_pins(&game->board);
+
+        legal_count = 0;
+        select_init(&ml, game, incheck, MOVE_NONE, FALSE);
+        while ((move = next_move(&ml)) != MOVE_NONE && legal_count < MAX_MOVE) {
+            legal[legal_count++] = move;
+        }
+
+        for (int i = -legal_count; i < moves_per_position; i++) {
+            //  all legal moves first, then random ones
+            move = i < 0 ? legal[legal_count + i] : fuzz_move(&game->board, legal, legal_count, prev, prev_count);
+            expected = fuzz_in_list(move, legal, legal_count);
+            result = is_valid(&game->board, move) && is_legal(&game->board, pins, incheck, move);
+
+            //  legality test against make/undo for the moves accepted by is_valid
+            made = result;
+            if (is_valid(&game->board, move)) {
+                make_move(&game->board, move);
+                made = !is_illegal(&game->board, move);
+                undo_move(&game->board);
+            }
+
+            tested++;
+            if (result) accepted++;
+            if (result == expected && made == expected) continue;
+
+            errors++;
+            if (errors <= FUZZ_MAX_ERRORS) {
+                printf("position %d %s\nmove 0x%08X expected: %d is_valid/is_legal: %d make_move: %d  ",
+                    positions, fen, (U32)move, expected, result, made);
+                util_print_move(move, TRUE);
+            }
+        }
+
+        memcpy(prev, legal, sizeof(MOVE) * legal_count);
+        prev_count = legal_count;
+    }
+
+    UINT elapsed = util_get_time() - start;
+    printf("positions: %d  moves tested: %" PRIu64 "  accepted: %" PRIu64 "  errors: %" PRIu64 "  time: %u ms\n",
+        positions, tested, accepted, errors, elapsed);
+
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
+    free(game);
+    fclose(f);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Random move value. Mix of plain random numbers, moves of own pieces with random fields,
+//  legal moves with flipped bits, and legal moves from the previous position (tt collisions).
+//-------------------------------------------------------------------------------------------------
+MOVE fuzz_move(BOARD *board, MOVE *legal, int legal_count, MOVE *prev, int prev_count)
+{
+    MOVE    move;
+    BBIX    own;
+    int     from;
+    int     to;
+    int     type;
+
+    switch (fuzz_random() % 4) {
+    case 0:
+        return (MOVE)fuzz_random();
+    case 1:
+        own.u64 = all_pieces_bb(board, side_on_move(board));
+        from = bb_first(own);
+        for (int n = fuzz_random() % 16; n > 0 && own.u64; n--) {
+            from = bb_first(own);
+            own.u64 &= ~square_bb(from);
+        }
+        to = fuzz_random() % 64;
+        type = fuzz_random() % MT_NULL;
+        move = (fuzz_random() & ((U32)0x7F << 25)) | ((fuzz_random() % 8) << 19) | (type << 12) | (from << 6) | to;
+        move |= piece_on_square(board, side_on_move(board), from) << 16;
+        if (type == MT_QUIET || type == MT_PAWN2 || move_is_castle(move)) move |= QUIET_BIT;
+        return move;
+    case 2:
+        if (legal_count == 0) return (MOVE)fuzz_random();
+        move = legal[fuzz_random() % legal_count];
+        move ^= (MOVE)1 << (fuzz_random() % 32);
+        if (fuzz_random() % 2) move ^= (MOVE)1 << (fuzz_random() % 32);
+        return move;
+    default:
+        if (prev_count == 0) return (MOVE)fuzz_random();
+        return prev[fuzz_random() % prev_count];
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Verify if move is in the list.
+//-------------------------------------------------------------------------------------------------
+int fuzz_in_list(MOVE move, MOVE *list, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (list[i] == move) return TRUE;
+    }
+    return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Pseudo random numbers (xorshift), same sequence on every run.
+//-------------------------------------------------------------------------------------------------
+U32 fuzz_random(void)
+{
+    fuzz_seed ^= fuzz_seed >> 12;
+    fuzz_seed ^= fuzz_seed << 25;
+    fuzz_seed ^= fuzz_seed >> 27;
+    return (U32)((fuzz_seed * 0x2545F4914F6CDD1D) >> 32);
+}
+
+//END
@@ -103,8 +103,6 @@ void test_open_gen(GAME *game, int depth)
     select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), 0, 0);
     
     while ((move = next_move(&ml)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, ml.pins, move))
-            continue;
         make_move(&game->board, move);
         test_open_gen(game, depth - 1);
         undo_move(&game->board);
@@ -26,7 +26,7 @@ U64 perft_nodes(GAME *game, int depth);
 
 void perft(int depth)
 {
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "perft.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -53,6 +53,8 @@ void perft(int depth)
         printf("\n");
     }
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     printf("perft completed.\n");
@@ -68,8 +70,6 @@ U64 perft_nodes(GAME *game, int depth) {
     select_init(&move_list, game, is_incheck(&game->board, side_on_move(&game->board)), 0, 0);
     
     while ((move = next_move(&move_list)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, move_list.pins, move))
-            continue;
         make_move(&game->board, move);
         nodes += perft_nodes(game, depth - 1);
         undo_move(&game->board);
@@ -78,4 +78,159 @@ U64 perft_nodes(GAME *game, int depth) {
     return nodes;
 }
 
+//-------------------------------------------------------------------------------------------------
+//  Fast perft: moves at depth 1 are counted without being made, subtree counts are saved in a
+//  hash table and root moves are split across threads.
+//-------------------------------------------------------------------------------------------------
+
+// Hash entry: data is node count << 8 | depth, check is board key ^ data (lockless).
+typedef struct s_perft_hash {
+    U64     check;
+    U64     data;
+}   PERFT_HASH;
+
+typedef struct s_perft_thread {
+    THREAD_ID   handle;
+    BOARD       board;
+    int         depth;
+    U64         nodes;
+}   PERFT_THREAD;
+
+PERFT_HASH      *perft_table;
+U64             perft_mask;
+MUTEX           perft_lock;
+MOVE_LIST       perft_root;
+int             perft_root_next;
+
+void    perft_thread(PERFT_THREAD *thread);
+U64     perft_bulk(BOARD *board, int depth);
+void    perft_gen_legal(BOARD *board, MOVE_LIST *ml);
+
+void perft_fast(BOARD *board, int depth, int threads, int hash_mb)
+{
+    PERFT_THREAD *thread_data = (PERFT_THREAD *)calloc((size_t)threads, sizeof(PERFT_THREAD));
+    if (thread_data == NULL) {
+        fprintf(stderr, "perft_fast.calloc: not enough memory for %d threads.\n", threads);
+        return;
+    }
+
+    perft_table = NULL;
+    perft_mask = 0;
+    if (hash_mb > 0) {
+        U64 entries = 1;
+        while (entries * 2 * sizeof(PERFT_HASH) <= (U64)hash_mb * 1024 * 1024) entries *= 2;
+        perft_table = (PERFT_HASH *)calloc((size_t)entries, sizeof(PERFT_HASH));
+        if (perft_table == NULL) {
+            fprintf(stderr, "perft_fast.calloc: not enough memory for %d MB hash, running without hash.\n", hash_mb);
+        }
+        else {
+            perft_mask = entries - 1;
+        }
+    }
+
+    MUTEX_INIT(perft_lock);
+    perft_gen_legal(board, &perft_root);
+
+    printf("threads: %d  hash: %d MB\n", threads, perft_table != NULL ? hash_mb : 0);
+    printf("Depth        Nodes    Secs  Nodes/Sec\n");
+
+    for (int d = 1; d <= depth; d++) {
+        U64 start = util_get_time_ns();
+        U64 nodes = 0;
+
+        if (d == 1) {
+            nodes = perft_root.count;
+        }
+        else {
+            perft_root_next = 0;
+            for (int i = 0; i < threads; i++) {
+                copy_board(&thread_data[i].board, board);
+                thread_data[i].depth = d - 1;
+                thread_data[i].nodes = 0;
+                THREAD_CREATE(thread_data[i].handle, perft_thread, &thread_data[i]);
+            }
+            for (int i = 0; i < threads; i++) {
+                THREAD_WAIT(thread_data[i].handle);
+                nodes += thread_data[i].nodes;
+            }
+        }
+
+        double seconds = (double)(util_get_time_ns() - start) / 1e9;
+        double nodes_per_second = seconds > 0 ? (double)nodes / seconds : 0;
+
+        printf("%5d %12" PRIu64 " %7.2f %10.0f\n", d, nodes, seconds, nodes_per_second);
+    }
+
+    free(perft_table);
+    perft_table = NULL;
+    free(thread_data);
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Take root moves until all of them are counted.
+//-------------------------------------------------------------------------------------------------
+void perft_thread(PERFT_THREAD *thread)
+{
+    while (TRUE) {
+        MUTEX_LOCK(perft_lock);
+        int index = perft_root_next++;
+        MUTEX_UNLOCK(perft_lock);
+        if (index >= perft_root.count) break;
+
+        make_move(&thread->board, perft_root.moves[index]);
+        thread->nodes += perft_bulk(&thread->board, thread->depth);
+        undo_move(&thread->board);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Count nodes for depth >= 1. Leaf moves are only generated.
+//-------------------------------------------------------------------------------------------------
+U64 perft_bulk(BOARD *board, int depth)
+{
+    MOVE_LIST   ml;
+    PERFT_HASH  *entry = NULL;
+    U64         nodes = 0;
+
+    if (perft_table != NULL && depth > 1) {
+        entry = &perft_table[board_key(board) & perft_mask];
+        PERFT_HASH saved = *entry;
+        if ((saved.check ^ saved.data) == board_key(board) && (int)(saved.data & 0xFF) == depth)
+            return saved.data >> 8;
+    }
+
+    perft_gen_legal(board, &ml);
+    if (depth == 1) return ml.count;
+
+    for (int i = 0; i < ml.count; i++) {
+        make_move(board, ml.moves[i]);
+        nodes += perft_bulk(board, depth - 1);
+        undo_move(board);
+    }
+
+    if (entry != NULL) {
+        U64 data = (nodes << 8) | (U64)depth;
+        entry->check = board_key(board) ^ data;
+        entry->data = data;
+    }
+
+    return nodes;
+}
+
+//-------------------------------------------------------------------------------------------------
+//  Generate legal moves.
+//-------------------------------------------------------------------------------------------------
+void perft_gen_legal(BOARD *board, MOVE_LIST *ml)
+{
+    ml->count = 0;
+    ml->pins = find_pins(board);
+    if (is_incheck(board, side_on_move(board))) {
+        gen_check_evasions(board, ml);
+    }
+    else {
+        gen_caps(board, ml);
+        gen_moves(board, ml);
+    }
+}
+
 //END
@@ -134,7 +134,7 @@ void perftx_test(TESTDATA *testdata)
     int     diff = 0;
     GAME    *game;
 
-    game = (GAME *)malloc(sizeof(GAME));
+    game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "perftx.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -226,6 +226,8 @@ void perftx_test(TESTDATA *testdata)
         printf("\n");
     }
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     if (diff) {
@@ -245,9 +247,6 @@ U64 perftx_moves(GAME *game, int depth) {
     
     while ((move = next_move(&move_list)) != MOVE_NONE) {
 
-        if (!is_pseudo_legal(&game->board, move_list.pins, move))
-            continue;
-
         make_move(&game->board, move);
 
         if (is_incheck(&game->board, side_on_move(&game->board))) {
@@ -276,8 +275,6 @@ int perftx_is_mated(GAME *game)
 
     select_init(&move_list, game, TRUE, MOVE_NONE, FALSE);
     while ((move = next_move(&move_list)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, move_list.pins, move))
-            continue;
         return FALSE; // Side on move has at least one legal move
     }
     return TRUE; //no legal moves
@@ -287,11 +287,12 @@ U64 perfty_nodes(GAME *game, int depth);
 
 void perfty(void)
 {
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "perfty.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
     }
+    new_game(game, FEN_NEW_GAME);
 
     for (int p = 0; p < MAXPOS; p++) {
 
@@ -311,6 +312,8 @@ void perfty(void)
         }
     }
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     printf("perfty completed.\n");
@@ -326,8 +329,6 @@ U64 perfty_nodes(GAME *game, int depth)
 
     select_init(&move_list, game, is_incheck(&game->board, side_on_move(&game->board)), MOVE_NONE, FALSE);
     while ((move = next_move(&move_list)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, move_list.pins, move))
-            continue;
         if (depth == 1) {
             nodes++;
         }
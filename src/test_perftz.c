@@ -26,7 +26,7 @@ void perftz_pos(GAME *game, char *fen, int depth, U64 expected);
 
 void perftz(void)
 {
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "perft.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -72,6 +72,8 @@ void perftz(void)
     perftz_pos(game, "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 ", 4, 23527);
     perftz_pos(game, "8/5k2/8/5N2/5Q2/2K5/8/8 w - - 0 ", 4, 23527);
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 
     printf("\nperftz completed.\n");
@@ -106,8 +108,6 @@ U64 perftz_nodes(GAME *game, int depth)
 
     select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), MOVE_NONE, FALSE);
     while ((move = next_move(&ml)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, ml.pins, move))
-            continue;
         make_move(&game->board, move);
         nodes += perftz_nodes(game, depth - 1);
         undo_move(&game->board);
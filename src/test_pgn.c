@@ -31,6 +31,7 @@ void test_pgn(char *pgn_filename)
     int        selected_positions = 0;
 
     tt_init(8);
+    memset(&game, 0, sizeof(GAME));
 
     while (read_game(pgn_file, pgn_moves, pgn_game, white, black, result)) {
         assert(strlen(pgn_moves) < 16384);
@@ -105,6 +106,8 @@ void test_pgn(char *pgn_filename)
     }
 
 
+    eval_cache_free(&game);
+    move_order_free(&game.move_order);
     fclose(out);
     fclose(pgn_file);
 }
@@ -22,7 +22,7 @@ You can find the GNU General Public License at http://www.gnu.org/licenses/
 //-------------------------------------------------------------------------------------------------
 void trans_table_test(char *fen, char *desc)
 {
-    GAME *game = (GAME *)malloc(sizeof(GAME));
+    GAME *game = (GAME *)calloc(1, sizeof(GAME));
     if (game == NULL) {
         fprintf(stderr, "trans_table_test.malloc: not enough memory for %d bytes.\n", (int)sizeof(GAME));
         return;
@@ -37,6 +37,10 @@ void trans_table_test(char *fen, char *desc)
     settings.single_move_time = 10000; 
     settings.total_move_time = 0;
     settings.use_book = FALSE;
+    settings.increment = 0;
+    settings.max_nodes = 0;
+    settings.mate_in = 0;
+    settings.search_moves_count = 0;
 
     search_run(game, &settings);
 
@@ -45,6 +49,8 @@ void trans_table_test(char *fen, char *desc)
 
     printf("\nTransposition table expected result: %s\n", desc);
 
+    eval_cache_free(game);
+    move_order_free(&game->move_order);
     free(game);
 }
 
@@ -139,8 +139,6 @@ MOVE pgn_engine_move(GAME *game, PGN_MOVE *pgn_move)
 
     select_init(&ml, game, is_incheck(&game->board, side_on_move(&game->board)), MOVE_NONE, FALSE);
     while ((move = next_move(&ml)) != MOVE_NONE) {
-        if (!is_pseudo_legal(&game->board, ml.pins, move))
-            continue;
         assert(is_valid(&game->board, move));
         pgn_move_desc(move, desc, TRUE, FALSE);
         if (strcmp(pgn_move->string, desc))